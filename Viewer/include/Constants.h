@@ -6,22 +6,38 @@
 #include <string>
 #include <stdlib.h>
 #include <map>
+#include <glm/glm.hpp>
 
 // Screen Sizes & Resolutions
 #define DEFAULT_HEIGHT						720
 #define DEFAULT_WIDTH						1280
 #define MAX_HEIGHT_4K						2160
 #define MAX_WIDTH_4K						3840
+// Pixels per unit of the projection plane, shared by drawing and picking
+#define SCREEN_SCALE						250.0f
 // Titles & Descriptions
 #define WINDOW_TITLE						"Mesh Viewer"
 // Source files
-#define CAMERA_SOURCE						"..\\Data\\camera.obj"
-#define SPHERE_SOURCE						"..\\Data\\sphere.obj"
-#define CUBE_SOURCE							"..\\Data\\cube.obj"
+#define OBJ_EXAMPLES_DIRECTORY				"..\\Data\\obj_examples"
 // Constants
 #define DISABLED							-1
 #define PI									3.141592653589793238462643383279502884L
 #define FACE_ELEMENTS						3
+#define SPHERE_DEFAULT_TESSELLATION			3
+#define SPHERE_MAX_TESSELLATION				6
+#define PRIMITIVES_GRID_SPACING				2.5f
+#define PAGED_MESH_CHUNK_TRIANGLES			65536
+#define PAGED_MESH_MAX_GRID_CELLS			64
+#define PAGED_MESH_DEFAULT_BUDGET_MB		256
+#define PAGED_MESH_BUILD_BUCKET_TRIANGLES	(4 * 1024 * 1024)
+#define PAGED_MESH_MAX_BUILD_BUCKETS		128
+#define LOD_MAX_LEVELS						6
+#define LOD_REDUCTION						4
+#define LOD_MIN_FACES						256
+#define LOD_PIXELS_PER_FACE					4
+#define SIMD_ALIGNMENT						32
+#define SIMD_FLOAT_WIDTH					8
+#define BVH_MIN_FACES						4096
 // Constant matrices
 #define ZERO_MATRIX							{ { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } }
 #define FLATTEN_MATRIX						{ { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 1 } }
@@ -76,6 +92,14 @@ typedef enum _PRIMITIVE_ {
 
 } PRIMITIVE;
 
+typedef enum _RENDER_MODE_ {
+
+	RENDER_WIREFRAME = 0,
+	// Filled, flat shaded triangles with a depth test
+	RENDER_SOLID
+
+} RENDER_MODE;
+
 typedef struct _PROJECTION_PARAMETERS_
 {
 	float left;
@@ -104,9 +128,9 @@ typedef struct _CUBE_LINES_
 
 const std::map<PRIMITIVE, std::string> PRIMITIVES = {
 
-	{SPHERE, SPHERE_SOURCE},
-	{CUBE, CUBE_SOURCE},
-	{CAMERA, CAMERA_SOURCE}
+	{SPHERE, "Sphere"},
+	{CUBE, "Cube"},
+	{CAMERA, "Camera"}
 
 };
 
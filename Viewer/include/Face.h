@@ -1,26 +0,0 @@
-#pragma once
-
-#ifndef __FACE_H__
-#define __FACE_H__
-
-#include <memory>
-#include <vector>
-#include <string>
-#include <glm/glm.hpp>
-
-class Face
-{
-private:
-	std::vector<int> vertexIndices;
-	std::vector<int> normalIndices;
-	std::vector<int> textureIndices;
-
-public:
-	Face(std::istream& issLine);
-	virtual ~Face();
-	const int Face::GetVertexIndex(int index);
-	const int Face::GetNormalIndex(int index);
-	const int Face::GetTextureIndex(int index);
-};
-
-#endif // !__FACE_H__
\ No newline at end of file
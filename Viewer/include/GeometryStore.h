@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef __GEOMETRYSTORE_H__
+#define __GEOMETRYSTORE_H__
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MeshGeometry.h"
+
+// Identifies geometry by the file it was read from. Files of the same size may have the same contents, only then
+// are the contents hashed, so loading a file of a new size never reads it twice.
+typedef struct _GEOMETRY_KEY_
+{
+	std::string filePath;
+	uint64_t fileSize;
+	uint64_t modifiedTime;
+	bool isHashed;
+	uint64_t contentHash;
+
+} GEOMETRY_KEY, *PGEOMETRY_KEY;
+
+typedef struct _GEOMETRY_ENTRY_
+{
+	GEOMETRY_KEY key;
+	std::weak_ptr<const MeshGeometry> geometry;
+
+} GEOMETRY_ENTRY, *PGEOMETRY_ENTRY;
+
+/*
+ * GeometryStore class.
+ * Content addressed registry of the geometry currently in use. Loading a file whose contents are already
+ * shown (under any path) hands out the same MeshGeometry instead of parsing and storing it again.
+ * Entries are weak, a geometry is released as soon as the last model using it is gone.
+ * All methods may be called from any thread.
+ */
+class GeometryStore
+{
+	private:
+		static std::mutex storeMutex;
+		static std::vector<GEOMETRY_ENTRY> entries;
+
+		static uint64_t HashContent(const char* data, size_t size);
+		static RETURN_VALUE GetFileStamp(const std::string& filePath, uint64_t& fileSize, uint64_t& modifiedTime);
+		// Hashes the file if it still has the size and modification time of the key
+		static bool HashFile(GEOMETRY_KEY& key);
+		static bool IsSameSource(const GEOMETRY_KEY& first, const GEOMETRY_KEY& second);
+		static void RemoveExpired();
+
+	public:
+		// The cheap key of a file, its path, size and modification time. Nothing of the file is read.
+		static RETURN_VALUE GetSourceKey(const std::string& filePath, GEOMETRY_KEY& key);
+		// Geometry in use with the same contents. Only hashes the file (and stores its hash in the key) when
+		// geometry of the same size is in use.
+		static std::shared_ptr<const MeshGeometry> Find(GEOMETRY_KEY& key);
+		static std::shared_ptr<const MeshGeometry> Insert(const GEOMETRY_KEY& key, const std::shared_ptr<const MeshGeometry>& geometry);
+		static size_t GetGeometryCount();
+};
+
+#endif // !__GEOMETRYSTORE_H__
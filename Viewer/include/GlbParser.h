@@ -0,0 +1,24 @@
+#pragma once
+
+#ifndef __GLBPARSER_H__
+#define __GLBPARSER_H__
+
+#include <string>
+#include "MeshGeometry.h"
+#include "ObjParser.h"
+#include "Constants.h"
+
+/*
+ * GlbParser class.
+ * Reads binary glTF 2.0 (.glb) files. The triangle primitives of every mesh in the default scene are merged
+ * into one geometry, with the node transformations applied. Accessors are copied straight out of the
+ * binary chunk when their layout matches ours (tightly packed floats or 32 bit indices) and converted otherwise.
+ */
+class GlbParser
+{
+	public:
+		static RETURN_VALUE ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+		static RETURN_VALUE Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+};
+
+#endif // !__GLBPARSER_H__
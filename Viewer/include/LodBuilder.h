@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef __LODBUILDER_H__
+#define __LODBUILDER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MeshGeometry.h"
+
+/*
+ * LodChain class.
+ * Simplified versions of one geometry, each about LOD_REDUCTION times smaller than the one before. Levels are
+ * appended by the LodBuilder thread while the chain is in use, so every method may be called from any thread.
+ */
+class LodChain
+{
+	private:
+		mutable std::mutex levelsMutex;
+		std::vector<std::shared_ptr<const MeshGeometry>> levels;
+
+	public:
+		void AddLevel(const std::shared_ptr<const MeshGeometry>& level);
+		size_t GetLevelCount() const;
+
+		// The most detailed of base and the levels built so far with at most maxFaceCount faces, or the coarsest
+		// one if none is small enough. level is 0 for base and n for the n-th simplified level.
+		std::shared_ptr<const MeshGeometry> Select(const std::shared_ptr<const MeshGeometry>& base, size_t maxFaceCount, size_t& level) const;
+};
+
+/*
+ * LodBuilder class.
+ * Builds the level of detail chains of loaded geometry on a background thread. Models showing the same geometry
+ * get the same chain. A chain nobody holds anymore is dropped, even if it is still being built.
+ */
+class LodBuilder
+{
+	private:
+		typedef struct _LOD_REQUEST_
+		{
+			std::shared_ptr<const MeshGeometry> geometry;
+			std::weak_ptr<LodChain> chain;
+
+		} LOD_REQUEST, *PLOD_REQUEST;
+
+		std::thread worker;
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+		std::deque<LOD_REQUEST> queue;
+		std::map<const MeshGeometry*, std::weak_ptr<LodChain>> chains;
+		std::atomic<bool> stopping;
+
+		LodBuilder();
+		~LodBuilder();
+
+		static LodBuilder& GetInstance();
+		void WorkerLoop();
+		void BuildChain(LOD_REQUEST& request);
+
+	public:
+		LodBuilder(const LodBuilder&) = delete;
+		LodBuilder& operator=(const LodBuilder&) = delete;
+
+		// The chain of geometry, queued for building on first request. nullptr for geometry too small to simplify.
+		static std::shared_ptr<LodChain> Request(const std::shared_ptr<const MeshGeometry>& geometry);
+};
+
+#endif // !__LODBUILDER_H__
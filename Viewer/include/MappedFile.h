@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <string>
+#include "Constants.h"
+
+/*
+ * MappedFile class.
+ * Read-only memory mapping of a whole file. The mapped bytes stay valid until Close() or destruction.
+ */
+class MappedFile
+{
+	private:
+		void* fileHandle;
+		void* mappingHandle;
+		const char* data;
+		size_t size;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	public:
+		MappedFile();
+		~MappedFile();
+
+		RETURN_VALUE Open(const std::string& filePath);
+		void Close();
+
+		const char* GetData() const { return data; }
+		const char* GetEnd() const { return data + size; }
+		size_t GetSize() const { return size; }
+		bool IsOpen() const { return fileHandle != nullptr; }
+};
+
+#endif // !__MAPPEDFILE_H__
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef __MESHBVH_H__
+#define __MESHBVH_H__
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// A node of the flattened hierarchy. Inner nodes have their first child right after them and the second one at
+// offset, leaves hold triangleCount faces starting at offset in the face order of the hierarchy.
+typedef struct _BVH_NODE_
+{
+	glm::vec3 minCoordinates;
+	uint32_t offset;
+	glm::vec3 maxCoordinates;
+	uint32_t triangleCount;
+
+} BVH_NODE, *PBVH_NODE;
+
+typedef struct _BVH_HIT_
+{
+	// Position along the ray, as a multiple of its direction
+	float distance;
+	uint32_t face;
+
+} BVH_HIT, *PBVH_HIT;
+
+typedef enum _VOLUME_TEST_ {
+
+	VOLUME_OUTSIDE = 0,
+	VOLUME_PARTIAL,
+	VOLUME_INSIDE
+
+} VOLUME_TEST;
+
+/*
+ * MeshBvh class.
+ * Bounding volume hierarchy over the faces of a mesh, built with the surface area heuristic over binned face
+ * centroids. The nodes are stored depth first in one array, so a traversal walks memory mostly forward.
+ */
+class MeshBvh
+{
+	private:
+		std::vector<BVH_NODE> nodes;
+		// Face indices in leaf order, every subtree covers a contiguous range
+		std::vector<uint32_t> faces;
+
+		uint32_t BuildNode(const std::vector<glm::vec3>& faceMin, const std::vector<glm::vec3>& faceMax, const std::vector<glm::vec3>& centroids, uint32_t begin, uint32_t end, int depth);
+		static VOLUME_TEST TestBox(const glm::vec4 planes[], int planeCount, const glm::vec3& minCoordinates, const glm::vec3& maxCoordinates);
+
+	public:
+		void Build(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices);
+
+		// The nearest face hit by origin + t * direction for t in [0, maxDistance]
+		bool Intersect(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BVH_HIT& hit) const;
+
+		// Appends the faces which may be visible through transformation (clip space: -w <= x, y <= w, w > 0).
+		// Returns how the whole mesh lies, nothing is appended unless it is VOLUME_PARTIAL.
+		VOLUME_TEST QueryFrustum(const glm::mat4x4& transformation, std::vector<uint32_t>& visibleFaces) const;
+
+		bool IsEmpty() const { return nodes.empty(); }
+		size_t GetNodeCount() const { return nodes.size(); }
+		size_t GetBytes() const { return nodes.capacity() * sizeof(BVH_NODE) + faces.capacity() * sizeof(uint32_t); }
+};
+
+#endif // !__MESHBVH_H__
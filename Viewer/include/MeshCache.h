@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef __MESHCACHE_H__
+#define __MESHCACHE_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "MeshGeometry.h"
+
+typedef struct _MESH_CACHE_HEADER_
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceSize;
+	uint64_t sourceModifiedTime;
+	uint64_t vertexCount;
+	uint64_t normalCount;
+	uint64_t textureVertexCount;
+	uint64_t faceCount;
+	uint32_t sourcePathLength;
+	float centroid[3];
+	float minCoordinates[3];
+	float maxCoordinates[3];
+
+} MESH_CACHE_HEADER, *PMESH_CACHE_HEADER;
+
+/*
+ * MeshCache class.
+ * Binary sidecar files (<model>.meshcache) holding the already normalized geometry of a loaded model.
+ * A cache entry is valid only for the source path, size and modification time it was written for.
+ * The layout after the header is: source path, then the welded vertex, normal and texture buffers and the
+ * index buffer, exactly as MeshGeometry keeps them. The normal and texture buffers are either empty or as
+ * long as the vertex buffer.
+ */
+class MeshCache
+{
+	private:
+		static bool FillHeader(const std::string& sourcePath, MESH_CACHE_HEADER& header);
+		static std::string GetCachePath(const std::string& sourcePath);
+
+	public:
+		static std::shared_ptr<MeshGeometry> Load(const std::string& sourcePath);
+		static RETURN_VALUE Store(const std::string& sourcePath, const MeshGeometry& geometry);
+};
+
+#endif // !__MESHCACHE_H__
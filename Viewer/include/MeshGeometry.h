@@ -0,0 +1,141 @@
+#pragma once
+
+#ifndef __MESHGEOMETRY_H__
+#define __MESHGEOMETRY_H__
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "Constants.h"
+#include "MeshBvh.h"
+#include "Span.h"
+#include "VertexStreams.h"
+
+// Geometry as read from a model file. Indices are 0-based with three per triangle, -1 marks a missing element.
+// Normal and texture indices are optional, their buffers are empty when no face uses them. Parsers only return
+// indices in range, vertex indices are never missing.
+typedef struct _MESH_DATA_
+{
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> textureVertices;
+	std::vector<int> vertexIndices;
+	std::vector<int> normalIndices;
+	std::vector<int> textureIndices;
+
+} MESH_DATA, *PMESH_DATA;
+
+// What a model is drawn from: the welded vertices with their normals (empty without normals) and the triangles over them.
+// The spans point into the geometry itself and are valid as long as it lives.
+typedef struct _MESH_VIEW_
+{
+	Span<const glm::vec3> vertices;
+	Span<const glm::vec3> normals;
+	Span<const uint32_t> indices;
+	Span<const uint32_t> edges;
+	// For every vertex, the one standing for its position in the edges
+	Span<const uint32_t> edgeVertices;
+
+} MESH_VIEW, *PMESH_VIEW;
+
+// Bytes held by the buffers of a geometry, by what they store
+typedef struct _MESH_MEMORY_
+{
+	size_t vertexBytes;
+	size_t normalBytes;
+	size_t textureBytes;
+	size_t indexBytes;
+	size_t edgeBytes;
+	size_t streamBytes;
+	size_t bvhBytes;
+	size_t totalBytes;
+
+} MESH_MEMORY, *PMESH_MEMORY;
+
+/*
+ * MeshGeometry class.
+ * The normalized, immutable geometry of a loaded model. Instances are shared between every MeshModel
+ * showing the same content (see GeometryStore), so nothing may change them after construction.
+ * Only the welded buffers the model is drawn from are kept, the parsed arrays are released once they are welded.
+ */
+class MeshGeometry
+{
+	private:
+		// Welded vertices, one per distinct (vertex, texture, normal) index tuple of the faces
+		std::vector<glm::vec3> vertexBuffer;
+		std::vector<glm::vec3> normalBuffer;
+		std::vector<glm::vec2> textureBuffer;
+		std::vector<uint32_t> indexBuffer;
+		// Pairs of welded vertex indices, every undirected edge between two distinct positions once
+		std::vector<uint32_t> edgeBuffer;
+		// For every welded vertex, the vertex its position is referred to by in the edge buffer
+		std::vector<uint32_t> edgeVertexBuffer;
+		// Computed properties
+		glm::vec3 centroid;
+		glm::vec3 minCoordinates;
+		glm::vec3 maxCoordinates;
+		CUBE_LINES cubeLines;
+		// Structure of arrays copies of the vertex and normal buffers, built the first time they are asked for
+		mutable std::once_flag streamsBuilt;
+		mutable VERTEX_STREAMS positionStreams;
+		mutable VERTEX_STREAMS normalStreams;
+		// Hierarchy over the faces for picking and culling, also built on first use
+		mutable std::once_flag bvhBuilt;
+		mutable MeshBvh bvh;
+
+		// Geometry restored from a binary cache is filled in by MeshCache
+		friend class MeshCache;
+		friend class MeshSimplifier;
+		MeshGeometry();
+
+		// Welds the face corners into vertices, normalizing the positions on the way
+		void buildVertexBuffers(const MESH_DATA& meshData, const glm::vec3& rawCentroid, float absoluteMin, float absoluteMax);
+		void buildEdgeBuffer();
+		void buildBorderCube();
+
+	public:
+		MeshGeometry(MESH_DATA&& meshData);
+		// Bounds only, for models whose triangles are kept elsewhere (see PagedMesh)
+		MeshGeometry(const glm::vec3& centroid, const glm::vec3& minCoordinates, const glm::vec3& maxCoordinates);
+		MeshGeometry(const MeshGeometry&) = delete;
+		MeshGeometry& operator=(const MeshGeometry&) = delete;
+
+		// Raw bounds and centroid, computed in parallel. The result is the same for any number of threads.
+		static void ComputeBounds(const std::vector<glm::vec3>& vertices, glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates);
+		// Plain serial version of ComputeBounds to test it against
+		static void ComputeBoundsReference(const std::vector<glm::vec3>& vertices, glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates);
+		// Whether ComputeBounds gives the bounds of the reference and its centroid within the tolerance
+		static bool MatchesReferenceBounds(const std::vector<glm::vec3>& vertices);
+		// Centers a raw vertex on the raw centroid and scales it into [-1, 1] by the absolute extents around the centroid
+		static glm::vec3 NormalizeVertex(const glm::vec3& vertex, const glm::vec3& centroid, float absoluteMin, float absoluteMax);
+		// Turns the centroid and bounds of raw vertices into the ones of their normalized vertices
+		static void NormalizeBounds(glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates);
+		// Numbers the distinct positions of the vertices. positionOf maps every vertex to its position,
+		// representatives holds the lowest vertex index of every position.
+		static void GroupPositions(const std::vector<glm::vec3>& vertices, std::vector<uint32_t>& positionOf, std::vector<uint32_t>& representatives);
+		// Pairs of vertex indices, every undirected edge of the triangles between two distinct positions once.
+		// edgeVertices, when given, receives the vertex standing for the position of every vertex in the edges.
+		static void BuildEdges(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, std::vector<uint32_t>& edges, std::vector<uint32_t>* edgeVertices = NULL);
+
+		const std::vector<glm::vec3>& GetVertexBuffer() const { return vertexBuffer; }
+		const std::vector<glm::vec3>& GetNormalBuffer() const { return normalBuffer; }
+		const std::vector<glm::vec2>& GetTextureBuffer() const { return textureBuffer; }
+		const std::vector<uint32_t>& GetIndexBuffer() const { return indexBuffer; }
+		const std::vector<uint32_t>& GetEdgeBuffer() const { return edgeBuffer; }
+		MESH_VIEW GetView() const;
+		const VERTEX_STREAMS& GetPositionStreams() const;
+		const VERTEX_STREAMS& GetNormalStreams() const;
+		const MeshBvh& GetBvh() const;
+		MESH_MEMORY GetMemoryUsage() const;
+		// Whether the bounds, centroid and welded positions match the serial reference for the data this geometry was built
+		// from, within the tolerance. Checked on every build in debug builds.
+		bool MatchesReference(const MESH_DATA& meshData) const;
+
+		const glm::vec3& GetCentroid() const { return centroid; }
+		const glm::vec3& GetMinCoordinates() const { return minCoordinates; }
+		const glm::vec3& GetMaxCoordinates() const { return maxCoordinates; }
+		const CUBE_LINES& GetBorderCube() const { return cubeLines; }
+};
+
+#endif // !__MESHGEOMETRY_H__
@@ -6,13 +6,25 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <memory>
-#include "Face.h"
+#include <vector>
 #include "Constants.h"
+#include "MeshGeometry.h"
+#include "LodBuilder.h"
+#include "PagedMesh.h"
+
+// Placement and color of one copy of an instanced model
+typedef struct _MODEL_INSTANCE_
+{
+	glm::mat4x4 transformation;
+	glm::vec4 color;
+
+} MODEL_INSTANCE, *PMODEL_INSTANCE;
 
 /*
  * MeshModel class.
  * This class represents a mesh model (with faces and normals informations).
- * You can use Utils::LoadMeshModel to create instances of this class from .obj files.
+ * The geometry itself is immutable and shared by every model showing the same content, a model only owns
+ * its transformations, color and name. You can use Utils::LoadMeshModel to create instances of this class from .obj files.
  */
 class MeshModel
 {
@@ -20,32 +32,36 @@ class MeshModel
 		// constant properties
 		glm::vec4 color;
 		std::string modelName;
-		std::vector<Face> faces;
-		std::vector<glm::vec3> vertices;
-		std::vector<glm::vec3> normals;
-		glm::vec3* vertexPositions;
-		glm::vec3* vertexNormals;
+		std::shared_ptr<const MeshGeometry> geometry;
+		// Simplified versions of the geometry, built in the background (nullptr for small geometry)
+		std::shared_ptr<LodChain> lods;
+		size_t lodLevel;
 		// Computed properties
 		glm::mat4x4 transformation;
 		glm::mat4x4 worldTransformation;
 		glm::mat4x4 normalTransformation;
-		glm::vec3 centroid;
-		glm::vec3 minCoordinates;
-		glm::vec3 maxCoordinates;
-		CUBE_LINES cubeLines;
 		// Helper properties
 		bool shouldRender;
 
 	public:
 		MeshModel(const MeshModel& primitive);
-		MeshModel(const std::vector<Face>& faces, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::string& modelName = "");
+		// Levels of detail are only built when hasLods is set, not for previews or geometry drawn without them
+		MeshModel(const std::shared_ptr<const MeshGeometry>& geometry, const std::string& modelName = "", bool hasLods = true);
 		virtual ~MeshModel();
 
-		std::pair<std::vector<glm::vec3>, std::pair<std::vector<glm::vec3>, std::vector<glm::vec3>>>* Render();
+		// Views of the shared geometry, nothing is copied
+		MESH_VIEW Render() const { return geometry->GetView(); }
 
 		std::vector<std::vector<glm::vec3>> GetModelTriangles();
 
-		void buildBorderCube(CUBE_LINES& cubeLines);
+		const std::shared_ptr<const MeshGeometry>& GetGeometry() const { return geometry; }
+		// Swaps in another version of the same content, as done while a model is still loading
+		void SetGeometry(const std::shared_ptr<const MeshGeometry>& geometry_, bool hasLods = true);
+		const std::shared_ptr<LodChain>& GetLods() const { return lods; }
+		// The level of detail drawn last, 0 being the full geometry
+		void SetLodLevel(size_t lodLevel_) { lodLevel = lodLevel_; }
+		size_t GetLodLevel() const { return lodLevel; }
+		const std::vector<uint32_t>& GetIndexBuffer() const { return geometry->GetIndexBuffer(); }
 
 		void SetModelTransformation(const glm::mat4x4& tranformation_);
 		const glm::mat4x4 GetModelTransformation() const;
@@ -65,9 +81,9 @@ class MeshModel
 
 		const bool IsModelRenderingActive() const { return shouldRender; }
 
-		glm::vec3 GetCentroid() { return centroid; }
+		const glm::vec3& GetCentroid() const { return geometry->GetCentroid(); }
 
-		CUBE_LINES& GetBorderCube() { return cubeLines; }
+		const CUBE_LINES& GetBorderCube() const { return geometry->GetBorderCube(); }
 };
 
 class PrimMeshModel : public MeshModel
@@ -76,7 +92,41 @@ class PrimMeshModel : public MeshModel
 		PRIMITIVE model;
 
 	public:
-		PrimMeshModel(const PRIMITIVE primitive);
+		PrimMeshModel(const PRIMITIVE primitive, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
+};
+
+/*
+ * PagedMeshModel class.
+ * A model whose triangles are read from disk chunk by chunk (see PagedMesh). Its geometry only holds the
+ * bounds, the renderer draws the chunks which are resident at the time.
+ */
+class PagedMeshModel : public MeshModel
+{
+	private:
+		std::shared_ptr<PagedMesh> pagedMesh;
+
+	public:
+		PagedMeshModel(const std::shared_ptr<PagedMesh>& pagedMesh, const std::string& modelName = "");
+
+		const std::shared_ptr<PagedMesh>& GetPagedMesh() const { return pagedMesh; }
+};
+
+/*
+ * InstancedMeshModel class.
+ * Many copies of one geometry, each with its own transformation and color. The instances are kept in a single
+ * contiguous array and are placed relative to the model transformation, so moving the model moves all of them.
+ */
+class InstancedMeshModel : public MeshModel
+{
+	private:
+		std::vector<MODEL_INSTANCE> instances;
+
+	public:
+		InstancedMeshModel(const std::shared_ptr<const MeshGeometry>& geometry, const std::string& modelName = "");
+
+		void ReserveInstances(size_t count) { instances.reserve(count); }
+		void AddInstance(const glm::mat4x4& transformation, const glm::vec4& color);
+		const std::vector<MODEL_INSTANCE>& GetInstances() const { return instances; }
 };
 
 class CameraModel : public PrimMeshModel
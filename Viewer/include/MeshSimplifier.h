@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef __MESHSIMPLIFIER_H__
+#define __MESHSIMPLIFIER_H__
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MeshGeometry.h"
+
+// Symmetric 4x4 error quadric of Garland and Heckbert, stored as its upper triangle
+typedef struct _QUADRIC_
+{
+	double a2, ab, ac, ad;
+	double b2, bc, bd;
+	double c2, cd;
+	double d2;
+
+} QUADRIC, *PQUADRIC;
+
+// A candidate edge collapse, only valid while both vertices still have the stamps it was computed with
+typedef struct _EDGE_COLLAPSE_
+{
+	double cost;
+	uint32_t keptVertex;
+	uint32_t removedVertex;
+	uint32_t keptStamp;
+	uint32_t removedStamp;
+	glm::vec3 position;
+
+	bool operator>(const _EDGE_COLLAPSE_& other) const { return cost > other.cost; }
+
+} EDGE_COLLAPSE, *PEDGE_COLLAPSE;
+
+/*
+ * MeshSimplifier class.
+ * Quadric error edge collapse. Welded vertices sharing a position are simplified as one, so texture and normal
+ * seams do not open up, and border edges are held in place by constraint planes. The simplified geometry keeps
+ * the bounds of its source (it is already normalized) and has positions and indices only.
+ */
+class MeshSimplifier
+{
+	private:
+		// Adds weight * (a * x + b * y + c * z + d)^2 for the plane with unit normal (a, b, c)
+		static void AddPlane(QUADRIC& quadric, double a, double b, double c, double d, double weight);
+		static void AddQuadric(QUADRIC& quadric, const QUADRIC& other);
+		static double GetError(const QUADRIC& quadric, const glm::vec3& position);
+		static EDGE_COLLAPSE GetCollapse(const std::vector<QUADRIC>& quadrics, const std::vector<glm::vec3>& positions, uint32_t keptVertex, uint32_t removedVertex);
+
+	public:
+		// Collapses edges until at most targetFaceCount faces are left, or no collapse keeps the surface intact.
+		// Returns nullptr when cancelled.
+		static std::shared_ptr<const MeshGeometry> Simplify(const MeshGeometry& source, size_t targetFaceCount, const std::atomic<bool>* cancelled = nullptr);
+};
+
+#endif // !__MESHSIMPLIFIER_H__
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef __MODELLOADER_H__
+#define __MODELLOADER_H__
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MeshModel.h"
+#include "ObjParser.h"
+
+class Scene;
+
+/*
+ * ModelLoadRequest class.
+ * Handle of a single background load. Progress and cancellation may be used from any thread.
+ */
+class ModelLoadRequest
+{
+	private:
+		std::string filePath;
+		bool isPaged;
+		LOAD_PROGRESS progress;
+		std::promise<std::shared_ptr<MeshModel>> promise;
+		std::future<std::shared_ptr<MeshModel>> result;
+		// Shows the partial geometry published by the loading thread until the model is done
+		std::shared_ptr<MeshModel> previewModel;
+
+		friend class ModelLoader;
+
+	public:
+		ModelLoadRequest(const std::string& filePath, bool isPaged = false);
+
+		const std::string& GetFilePath() const { return filePath; }
+		bool IsPaged() const { return isPaged; }
+		float GetProgress() const { return progress.fraction; }
+		void Cancel() { progress.cancelled = true; }
+		bool IsCancelled() const { return progress.cancelled; }
+		bool IsDone() const;
+};
+
+/*
+ * ModelLoader class.
+ * Loads models on a worker thread, one request after the other. Finished models are handed to
+ * the scene by Poll(), which is called from the main thread, so the scene is never touched concurrently.
+ * While a model loads, Poll() also keeps a preview of it in the scene: its bounds first, then a thinned out
+ * version and finally the complete model.
+ */
+class ModelLoader
+{
+	private:
+		std::thread worker;
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+		std::deque<std::shared_ptr<ModelLoadRequest>> queue;
+		std::vector<std::shared_ptr<ModelLoadRequest>> requests;
+		bool stopping;
+
+		void WorkerLoop();
+		bool UpdatePreview(Scene* scene, ModelLoadRequest* request);
+
+	public:
+		ModelLoader();
+		~ModelLoader();
+
+		// Paged models are split into chunks on disk and only partially kept in memory (see PagedMesh)
+		std::shared_ptr<ModelLoadRequest> Load(const std::string& filePath, bool isPaged = false);
+		int Poll(Scene* scene);
+
+		const std::vector<std::shared_ptr<ModelLoadRequest>>& GetRequests() const { return requests; }
+};
+
+#endif // !__MODELLOADER_H__
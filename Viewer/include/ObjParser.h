@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef __OBJPARSER_H__
+#define __OBJPARSER_H__
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include "MeshGeometry.h"
+#include "Constants.h"
+
+// Shared between a loading thread, which reports the parsed fraction, and its requester, which may cancel it.
+// The loading thread may also publish partial geometry while it runs, the requester shows the latest one.
+typedef struct _LOAD_PROGRESS_
+{
+	std::atomic<float> fraction;
+	std::atomic<bool> cancelled;
+	std::mutex previewMutex;
+	std::shared_ptr<const MeshGeometry> preview;
+
+} LOAD_PROGRESS, *PLOAD_PROGRESS;
+
+/*
+ * ObjParser class.
+ * Parses .obj records straight from memory mapped bytes, without strings, streams or locales.
+ * Large files are split into newline aligned chunks which are parsed concurrently and merged in file order.
+ */
+class ObjParser
+{
+	public:
+		static RETURN_VALUE ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+		static RETURN_VALUE Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+		static RETURN_VALUE ParseParallel(const char* begin, const char* end, MESH_DATA& meshData, unsigned int threadCount, PLOAD_PROGRESS progress = nullptr);
+
+		// Streams the positions and the vertex indices of the faces (0-based, resolved like Parse does) to the
+		// callbacks in file order, keeping nothing of the file in memory. Progress is reported within
+		// [progressBegin, progressEnd], FAILURE is returned once the load is cancelled.
+		static RETURN_VALUE Scan(const std::string& filePath, const std::function<void(const glm::vec3&)>& onVertex, const std::function<void(const int*)>& onFace,
+			PLOAD_PROGRESS progress = nullptr, float progressBegin = 0.0f, float progressEnd = 1.0f);
+
+		static const char* ParseFloat(const char* cursor, const char* end, float& value);
+		static const char* ParseInt(const char* cursor, const char* end, int& value);
+
+		static void Benchmark(const std::string& directory);
+};
+
+#endif // !__OBJPARSER_H__
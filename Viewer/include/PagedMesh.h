@@ -0,0 +1,154 @@
+#pragma once
+
+#ifndef __PAGEDMESH_H__
+#define __PAGEDMESH_H__
+
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MeshGeometry.h"
+#include "ObjParser.h"
+
+typedef struct _PAGED_MESH_HEADER_
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceSize;
+	uint64_t sourceModifiedTime;
+	uint64_t vertexCount;
+	uint64_t faceCount;
+	uint32_t chunkCount;
+	uint32_t sourcePathLength;
+	float centroid[3];
+	float minCoordinates[3];
+	float maxCoordinates[3];
+
+} PAGED_MESH_HEADER, *PPAGED_MESH_HEADER;
+
+// One pass over a mesh source, like ObjParser::Scan: every position, and every face as three 0-based position
+// indices, in file order. The last two arguments are the range the pass reports its progress in.
+typedef std::function<RETURN_VALUE(const std::function<void(const glm::vec3&)>&, const std::function<void(const int*)>&, float, float)> MESH_SCAN;
+
+// Where a chunk lives in the page file and the bounds of its (normalized) vertices
+typedef struct _PAGED_CHUNK_ENTRY_
+{
+	uint64_t offset;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	float minCoordinates[3];
+	float maxCoordinates[3];
+
+} PAGED_CHUNK_ENTRY, *PPAGED_CHUNK_ENTRY;
+
+// A self contained piece of the mesh, its indices and edges refer to its own vertices only
+typedef struct _PAGED_CHUNK_
+{
+	PAGED_CHUNK_ENTRY entry;
+	std::vector<glm::vec3> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> edges;
+	bool resident;
+	// Requested from the loading thread and not handed back yet
+	bool loading;
+	uint64_t lastUsedFrame;
+	std::list<size_t>::iterator recentlyUsed;
+
+} PAGED_CHUNK, *PPAGED_CHUNK;
+
+// A chunk read by the loading thread, waiting to be made resident by the render thread
+typedef struct _PAGED_CHUNK_LOAD_
+{
+	size_t chunkIndex;
+	RETURN_VALUE result;
+	std::vector<glm::vec3> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> edges;
+
+} PAGED_CHUNK_LOAD, *PPAGED_CHUNK_LOAD;
+
+/*
+ * PagedMesh class.
+ * A mesh too large to be kept in memory. Build() splits the triangles of a model into the cells of a uniform
+ * grid and writes every non empty cell as a chunk into a page file (<model>.meshpages). The source is streamed
+ * twice and sorted on disk, so building takes bounded memory whatever the size of the model. At runtime only the
+ * chunks inside the view volume are read, and the least recently seen ones are dropped whenever the resident
+ * chunks would exceed the byte budget. Chunks are read on a loading thread, the render thread only draws the
+ * ones which are resident already, so paging never stalls a frame. Like MeshCache, a page file is valid only
+ * for the source path, size and modification time it was written for.
+ */
+class PagedMesh
+{
+	private:
+		// Only the render thread touches the chunks, the loading thread reads into PAGED_CHUNK_LOADs
+		std::vector<PAGED_CHUNK> chunks;
+		// Resident chunks, the most recently seen first
+		std::list<size_t> recentlyUsed;
+		uint64_t faceCount;
+		uint64_t byteBudget;
+		uint64_t residentBytes;
+		uint64_t frame;
+		glm::vec3 centroid;
+		glm::vec3 minCoordinates;
+		glm::vec3 maxCoordinates;
+		// The page file is read by the loading thread only
+		std::ifstream file;
+		std::thread loader;
+		std::mutex loadMutex;
+		std::condition_variable loadCondition;
+		std::deque<size_t> requestedChunks;
+		std::vector<PAGED_CHUNK_LOAD> loadedChunks;
+		bool stopping;
+
+		PagedMesh();
+
+		static bool FillHeader(const std::string& sourcePath, PAGED_MESH_HEADER& header);
+		static std::string GetPagePath(const std::string& sourcePath);
+		static uint64_t GetChunkBytes(const PAGED_CHUNK_ENTRY& entry);
+		// The memory a chunk takes once resident, its edges included
+		static uint64_t GetResidentChunkBytes(const PAGED_CHUNK_ENTRY& entry);
+
+		void LoaderLoop();
+		RETURN_VALUE ReadChunk(PAGED_CHUNK_LOAD& load);
+		// Makes the chunks the loading thread handed back resident, as far as the budget allows
+		void InstallLoadedChunks();
+		// Drops the least recently seen chunks until chunkBytes more fit into the budget
+		bool MakeRoom(uint64_t chunkBytes);
+
+	public:
+		~PagedMesh();
+		PagedMesh(const PagedMesh&) = delete;
+		PagedMesh& operator=(const PagedMesh&) = delete;
+
+		static RETURN_VALUE Build(const std::string& sourcePath, const MESH_SCAN& scan, PLOAD_PROGRESS progress = nullptr);
+		static std::shared_ptr<PagedMesh> Open(const std::string& sourcePath, uint64_t byteBudget);
+
+		// Whether the box is entirely beyond one side of the clip space of transformation, or behind the viewer
+		static bool IsOutsideViewVolume(const glm::mat4x4& transformation, const float minCoordinates[3], const float maxCoordinates[3]);
+
+		// Requests the chunks seen through the given model-view-projection transformation from the loading thread,
+		// within the byte budget, and makes the ones read since the last call resident. Never waits for the disk.
+		void UpdateResidency(const glm::mat4x4& transformation);
+
+		void SetByteBudget(uint64_t byteBudget_) { byteBudget = byteBudget_; }
+		uint64_t GetByteBudget() const { return byteBudget; }
+		uint64_t GetResidentBytes() const { return residentBytes; }
+		size_t GetResidentChunkCount() const { return recentlyUsed.size(); }
+		size_t GetChunkCount() const { return chunks.size(); }
+		uint64_t GetFaceCount() const { return faceCount; }
+		const std::vector<PAGED_CHUNK>& GetChunks() const { return chunks; }
+
+		const glm::vec3& GetCentroid() const { return centroid; }
+		const glm::vec3& GetMinCoordinates() const { return minCoordinates; }
+		const glm::vec3& GetMaxCoordinates() const { return maxCoordinates; }
+};
+
+#endif // !__PAGEDMESH_H__
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef __PLYPARSER_H__
+#define __PLYPARSER_H__
+
+#include <string>
+#include <vector>
+#include "MeshGeometry.h"
+#include "ObjParser.h"
+#include "Constants.h"
+
+typedef enum _PLY_TYPE_ {
+
+	PLY_INT8 = 0,
+	PLY_UINT8,
+	PLY_INT16,
+	PLY_UINT16,
+	PLY_INT32,
+	PLY_UINT32,
+	PLY_FLOAT32,
+	PLY_FLOAT64,
+	PLY_INVALID
+
+} PLY_TYPE;
+
+typedef struct _PLY_PROPERTY_
+{
+	std::string name;
+	PLY_TYPE type;
+	// Lists store a count of countType followed by that many values of type
+	bool isList;
+	PLY_TYPE countType;
+	size_t offset;
+
+} PLY_PROPERTY, *PPLY_PROPERTY;
+
+typedef struct _PLY_ELEMENT_
+{
+	std::string name;
+	size_t count;
+	std::vector<PLY_PROPERTY> properties;
+	// Size of a record, only meaningful when none of the properties is a list
+	size_t stride;
+	bool hasLists;
+
+} PLY_ELEMENT, *PPLY_ELEMENT;
+
+/*
+ * PlyParser class.
+ * Reads binary (little or big endian) .ply files with vertex positions, optional vertex normals and polygon faces.
+ * When the file is in the native byte order and the coordinates are consecutive floats, whole records are
+ * copied instead of being read property by property. Polygons are split into triangle fans.
+ */
+class PlyParser
+{
+	private:
+		static RETURN_VALUE ParseHeader(const char*& cursor, const char* end, std::vector<PLY_ELEMENT>& elements, bool& isBigEndian);
+		static const char* ReadVertices(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes, MESH_DATA& meshData);
+		static const char* ReadFaces(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes, MESH_DATA& meshData, PLOAD_PROGRESS progress, const char* begin);
+		static const char* SkipElement(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes);
+
+	public:
+		static RETURN_VALUE ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+		static RETURN_VALUE Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+};
+
+#endif // !__PLYPARSER_H__
@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef __PRIMITIVEGENERATOR_H__
+#define __PRIMITIVEGENERATOR_H__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "MeshGeometry.h"
+#include "Constants.h"
+
+/*
+ * PrimitiveGenerator class.
+ * Builds the geometry of the built-in primitives in code, so adding one never touches the disk.
+ * The cube and the camera are compile time tables, the sphere is an icosahedron subdivided tessellationLevel times.
+ * Every (primitive, tessellation level) pair is generated once and then shared by all the models showing it.
+ */
+class PrimitiveGenerator
+{
+	private:
+		static std::mutex generatorMutex;
+		static std::map<std::pair<PRIMITIVE, unsigned int>, std::shared_ptr<const MeshGeometry>> geometries;
+
+		static void BuildCube(MESH_DATA& meshData);
+		static void BuildSphere(MESH_DATA& meshData, unsigned int tessellationLevel);
+		static void BuildCamera(MESH_DATA& meshData);
+
+	public:
+		static void Build(PRIMITIVE primitive, MESH_DATA& meshData, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
+		static std::shared_ptr<const MeshGeometry> GetGeometry(PRIMITIVE primitive, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
+};
+
+#endif // !__PRIMITIVEGENERATOR_H__
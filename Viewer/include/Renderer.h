@@ -4,6 +4,8 @@
 #define __RENDERER_H__
 
 #include "Scene.h"
+#include "WorkerPool.h"
+#include <string>
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -12,6 +14,15 @@
 
 class Scene;
 
+// A triangle or a line waiting in the tile bins, in screen space. Lines use the first two points.
+typedef struct _RASTER_PRIMITIVE_
+{
+	glm::vec3 points[3];
+	glm::vec3 color;
+	bool isLine;
+
+} RASTER_PRIMITIVE, *PRASTER_PRIMITIVE;
+
 /*
  * Renderer class.
  */
@@ -39,7 +50,67 @@ private:
 	glm::mat4x4 normalTransformation;
 	glm::mat4x4 projection;
 
+	// Screen positions of the vertices drawn last (x and y in pixels as ToViewPlane places them, unrounded, and the
+	// depth in z), kept between draws to avoid reallocating
+	std::vector<glm::vec3> screenVertices;
+
+	// Fills screenVertices with the cartesian form of transformation * vertex, from the x/y/z arrays when given
+	void TransformVertices(const glm::mat4x4& transformation, Span<const glm::vec3> vertices, const VERTEX_STREAMS* vertexStreams);
+
+	// Draws lines between pairs of screenVertices
+	void DrawEdges(Span<const uint32_t> edges, const glm::vec3& color);
+	void DrawLine(uint32_t first, uint32_t second, const glm::vec3& color);
+
+	// Fills the triangles over screenVertices with depth testing, flat shaded by how much each face turns to
+	// the viewer. viewDirection points from the model to the viewer in object coordinates.
+	void FillTriangles(Span<const glm::vec3> vertices, Span<const uint32_t> indices, const glm::vec3& viewDirection, const glm::vec3& color);
+	void DrawTriangle(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& color);
+	// Half-space rasterization of one triangle in screen space, limited to the pixels in [minX, maxX) x [minY, maxY)
+	void RasterizeTriangle(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& color, int minX, int minY, int maxX, int maxY);
+	// The pixels DrawLine sets between two pixel positions, limited to [minX, maxX) x [minY, maxY)
+	void RasterizeLine(float x1, float y1, float x2, float y2, const glm::vec3& color, int minX, int minY, int maxX, int maxY);
+	glm::vec3 GetViewDirection(Scene* scene);
+	void ClearDepthBuffer();
+	// Everything Render() does but handing the color buffer to OpenGL
+	void DrawScene(Scene* scene);
+
+	// Sort-middle rasterization: while a frame is drawn, primitives are only binned into the screen tiles their
+	// bounds touch, and FlushTiles() then rasterizes the tiles in parallel. A tile gets its primitives in the
+	// order they were drawn and no two tiles share a pixel, so the result is the one drawing them directly gives.
+	WorkerPool workerPool;
+	bool useTiles;
+	int tileColumns;
+	int tileRows;
+	std::vector<RASTER_PRIMITIVE> primitives;
+	std::vector<std::vector<uint32_t>> tileBins;
+
+	void BinPrimitive(const RASTER_PRIMITIVE& primitive, int left, int bottom, int right, int top);
+	void FlushTiles();
+
+	// Faces of the drawn model found in view by its hierarchy, their triangles, and the edges between their corners
+	std::vector<uint32_t> visibleFaces;
+	std::vector<uint32_t> visibleIndices;
+	std::vector<uint8_t> visibleEdgeVertices;
+	std::vector<uint32_t> visibleEdges;
+
+	// Clip space to screen, and object to screen space of the current object matrices. Computed once per draw call,
+	// so every vertex costs a single matrix product. Screen z is a depth which grows away from the viewer.
+	glm::mat4x4 GetScreenMapping(const glm::mat4x4& projection);
+	glm::mat4x4 GetScreenTransformation(Scene* scene);
+
+	// Object to clip space of the current object matrices, where the visible part of the view plane is [-1, 1]
+	glm::mat4x4 GetViewVolumeTransformation(Scene* scene);
+
+	// Whether a box in object coordinates is out of the view of transformation (as GetViewVolumeTransformation builds it)
+	bool IsOutsideView(const glm::mat4x4& viewVolumeTransformation, const MeshGeometry& geometry);
+	// Models and instances drawn and skipped in the frame being drawn
+	CULLING_STATS cullingStats;
+
+	// How many faces the model may draw with, from the screen area its bounds cover
+	size_t GetLodFaceBudget(Scene* scene, const MeshGeometry& geometry);
+
 	glm::uvec2 ToViewPlane(const glm::vec2& point);
+	glm::uvec2 ToPixel(const glm::vec3& screenPoint) { return glm::vec2(round(screenPoint.x), round(screenPoint.y)); }
 	void OrderPoints(float& x1, float& x2, float& y1, float& y2);
 	bool IsSlopeBiggerThanOne(float x1, float x2, float y1, float y2) { return (fabs(y2 - y1) > fabs(x2 - x1)); }
 
@@ -47,7 +118,7 @@ private:
 	void PutPixel(int x, int y, bool steep, const glm::vec3& color);
 
 	void GetDeltas(IN float x1, IN float x2, IN float y1, IN float y2, OUT float* pDx, OUT float* pDy);
-	void yStepErrorUpdate(float dx, float dy, float& error, int& y, const int& ystep);
+	void yStepErrorUpdate(float dx, float dy, float& error, int64_t& y, const int& ystep);
 
 public:
 	Renderer(int viewportWidth, int viewportHeight, int viewportX = 0, int viewportY = 0);
@@ -55,6 +126,9 @@ public:
 
 	void Render(Scene* scene);
 	void SwapBuffers();
+	// Draws the models of directory in wireframe and solid mode, directly and through the screen tiles, and prints
+	// the frame times and whether both give the same pixels and depths
+	void Benchmark(const std::string& directory);
 	void ClearColorBuffer(const glm::vec3& color);
 	void SetViewport(int viewportWidth, int viewportHeight, int viewportX = 0, int viewportY = 0);
 
@@ -70,9 +144,11 @@ public:
 
 	void DrawAxis(Scene* scene);
 	void DrawLine(const glm::uvec2& p1, const glm::uvec2& p2, const glm::vec3& color);
-	void DrawTriangles(Scene* scene, const std::vector<glm::vec3>* triangles, bool shouldDrawFaceNormals = false, const glm::vec3* modelCentroid = NULL, UINT32 normScaleRate = 1, bool isCamera = false);
-	void DrawVerticesNormals(Scene* scene, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals);
-	void DrawBorderCube(Scene* scene, CUBE_LINES& cubeLines);
+	void DrawTriangles(Scene* scene, Span<const glm::vec3> vertices, Span<const uint32_t> indices, bool shouldDrawFaceNormals = false, const glm::vec3* modelCentroid = NULL, UINT32 normScaleRate = 1, bool isCamera = false, const VERTEX_STREAMS* vertexStreams = NULL, Span<const uint32_t> edges = Span<const uint32_t>());
+	void DrawVerticesNormals(Scene* scene, Span<const glm::vec3> vertices, Span<const glm::vec3> normals);
+	void DrawBorderCube(Scene* scene, const CUBE_LINES& cubeLines);
+	void DrawPagedModel(Scene* scene, PagedMeshModel* model);
+	void DrawInstancedModel(Scene* scene, InstancedMeshModel* model);
 };
 
 #endif // !__RENDERER_H__
@@ -15,6 +15,17 @@
 
 class Renderer;
 
+// What the renderer drew of the scene in the last frame. An instanced model counts as visible when any of its
+// instances is.
+typedef struct _CULLING_STATS_
+{
+	size_t visibleModels;
+	size_t culledModels;
+	size_t visibleInstances;
+	size_t culledInstances;
+
+} CULLING_STATS, *PCULLING_STATS;
+
 /*
  * Scene class.
  * This class holds all the scene information (models, cameras, lights, etc..)
@@ -32,20 +43,33 @@ class Scene {
 		bool drawVerticesNormals;
 		bool drawFacesNormals;
 		bool drawBorderCube;
+		bool useVertexStreams;
+		bool useLevelOfDetail;
+		bool useTiledRasterizer;
+		RENDER_MODE renderMode;
+		CULLING_STATS cullingStats;
 
 	public:
 		Scene();
 
 		// Model related functions
 		void AddModel(const std::shared_ptr<MeshModel>& model);
+		void RemoveModel(const std::shared_ptr<MeshModel>& model);
+		bool HasModel(const std::shared_ptr<MeshModel>& model) const;
 		const int GetModelCount() const;
 		void SetActiveModelIndex(int index);
 		const int GetActiveModelIndex() const;
-		void AddPrimitiveModel(PRIMITIVE primitiveModel);
+		void AddPrimitiveModel(PRIMITIVE primitiveModel, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
+		void AddPrimitiveModels(PRIMITIVE primitiveModel, unsigned int count, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
+		// A single model drawing count copies of the primitive, laid out like AddPrimitiveModels does
+		void AddPrimitiveInstances(PRIMITIVE primitiveModel, unsigned int count, unsigned int tessellationLevel = SPHERE_DEFAULT_TESSELLATION);
 		void NextModel();
 		void DeleteActiveModel();
 		glm::mat4x4 GetActiveModelTransformation();
 		std::vector<std::shared_ptr<MeshModel>>& GetModels();
+		// Makes the nearest model under viewPoint (the view plane, as ToViewPlane maps it) active. Returns its index
+		// and the face hit, or DISABLED for both when nothing is there.
+		int PickModel(const glm::vec2& viewPoint, int& face);
 
 		// Camera related functions
 		void AddCamera(Camera* camera);
@@ -58,15 +82,25 @@ class Scene {
 		const bool ShouldRenderCamera(int cameraIndex);
 		const glm::mat4x4 GetActiveCameraTransformation();
 		const glm::mat4x4 GetActiveCameraProjection();
-		std::vector<Camera*> GetCameras();
+		const std::vector<Camera*>& GetCameras() const;
 
 		// Actions
 		void ShowVerticesNormals(const bool key);
 		void ShowFacesNormals(const bool key);
 		void ShowBorderCube(const bool key);
+		void UseVertexStreams(const bool key);
+		void UseLevelOfDetail(const bool key);
+		void UseTiledRasterizer(const bool key);
+		void SetRenderMode(const RENDER_MODE mode);
 		bool ShouldShowVerticesNormals() { return drawVerticesNormals; }
 		bool ShouldShowFacesNormals() { return drawFacesNormals; }
 		bool ShouldShowBorderCube() { return drawBorderCube; }
+		bool ShouldUseVertexStreams() { return useVertexStreams; }
+		bool ShouldUseLevelOfDetail() { return useLevelOfDetail; }
+		bool ShouldUseTiledRasterizer() { return useTiledRasterizer; }
+		RENDER_MODE GetRenderMode() { return renderMode; }
+		void SetCullingStats(const CULLING_STATS& stats) { cullingStats = stats; }
+		const CULLING_STATS& GetCullingStats() const { return cullingStats; }
 
 		// Projection functions
 		void SetOrthographicProjection(const PROJECTION_PARAMETERS);
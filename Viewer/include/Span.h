@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef __SPAN_H__
+#define __SPAN_H__
+
+#include <cstddef>
+
+/*
+ * Span class.
+ * A non-owning view of contiguous elements, in the spirit of C++20's std::span. Nothing is copied,
+ * so the viewed array has to outlive the span and must not be resized while the span is used.
+ */
+template <typename T>
+class Span
+{
+	private:
+		T* elements;
+		size_t count;
+
+	public:
+		Span() : elements(nullptr), count(0) {}
+		Span(T* elements_, size_t count_) : elements(elements_), count(count_) {}
+
+		// Views any container with contiguous storage, such as std::vector
+		template <typename Container>
+		Span(Container& container) : elements(container.data()), count(container.size()) {}
+
+		T* data() const { return elements; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		T* begin() const { return elements; }
+		T* end() const { return elements + count; }
+
+		T& operator[](size_t index) const { return elements[index]; }
+};
+
+#endif // !__SPAN_H__
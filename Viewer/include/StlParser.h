@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef __STLPARSER_H__
+#define __STLPARSER_H__
+
+#include <string>
+#include "MeshGeometry.h"
+#include "ObjParser.h"
+#include "Constants.h"
+
+/*
+ * StlParser class.
+ * Reads binary .stl files. Every 50 byte triangle record is copied as a block, corners which share
+ * a position are merged into a single vertex and the face normals are kept when the file has them.
+ */
+class StlParser
+{
+	public:
+		static RETURN_VALUE ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+		static RETURN_VALUE Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress = nullptr);
+};
+
+#endif // !__STLPARSER_H__
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef __TRANSFORMKERNELS_H__
+#define __TRANSFORMKERNELS_H__
+
+#include <glm/glm.hpp>
+#include <string>
+#include "VertexStreams.h"
+
+typedef enum _TRANSFORM_KERNEL_ {
+
+	TRANSFORM_KERNEL_AUTO = -1,
+	TRANSFORM_KERNEL_SCALAR = 0,
+	TRANSFORM_KERNEL_SSE41,
+	TRANSFORM_KERNEL_AVX2
+
+} TRANSFORM_KERNEL;
+
+/*
+ * TransformKernels class.
+ * Vertex transform with perspective divide, from packed glm::vec3 or from VERTEX_STREAMS, into packed glm::vec3.
+ * The SSE4.1 and AVX2 kernels transform 4 and 8 vertices at a time. The best one the CPU supports is picked on
+ * first use. All kernels do the same float operations in the same order, so their results are identical.
+ */
+class TransformKernels
+{
+	private:
+		static TRANSFORM_KERNEL DetectKernel();
+		static TRANSFORM_KERNEL Resolve(TRANSFORM_KERNEL kernel);
+
+		static void TransformSse41(const float* vertices, size_t count, const glm::mat4x4& transformation, float* transformed);
+		static void TransformSse41(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, float* transformed);
+		static void TransformAvx2(const float* vertices, size_t count, const glm::mat4x4& transformation, float* transformed);
+		static void TransformAvx2(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, float* transformed);
+
+	public:
+		// The fastest kernel this CPU and operating system support
+		static TRANSFORM_KERNEL GetBestKernel();
+		static const char* GetKernelName(TRANSFORM_KERNEL kernel);
+
+		// Writes the cartesian form of transformation * (vertex, 1) for every vertex into transformed[0, count).
+		// Kernels the CPU does not support fall back to the best one it does.
+		static void Transform(const glm::vec3* vertices, size_t count, const glm::mat4x4& transformation, glm::vec3* transformed, TRANSFORM_KERNEL kernel = TRANSFORM_KERNEL_AUTO);
+		static void Transform(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, glm::vec3* transformed, TRANSFORM_KERNEL kernel = TRANSFORM_KERNEL_AUTO);
+
+		// Prints the vertex throughput of every supported kernel on the .obj files in directory
+		static void Benchmark(const std::string& directory);
+};
+
+#endif // !__TRANSFORMKERNELS_H__
@@ -5,7 +5,9 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <memory>
 #include "MeshModel.h"
+#include "ObjParser.h"
 
 /*
  * Utils class.
@@ -17,6 +19,8 @@ class Utils
 		static glm::vec3 Vec3fFromStream(std::istream& issLine);
 		static glm::vec2 Vec2fFromStream(std::istream& issLine);
 		static MeshModel LoadMeshModel(const std::string& filePath);
+		static std::shared_ptr<MeshModel> LoadMeshModel(const std::string& filePath, PLOAD_PROGRESS progress);
+		static std::shared_ptr<MeshModel> LoadPagedMeshModel(const std::string& filePath, PLOAD_PROGRESS progress);
 
 		static glm::vec4 ToHomogeneousForm(const glm::vec3& normalForm);
 		static glm::vec4 ExpandToVec4(const glm::vec3& vector);
@@ -29,9 +33,15 @@ class Utils
 		
 		static glm::vec3 GetColor(COLOR color);
 
-	private:
 		static std::string GetFileName(const std::string& filePath);
+
+	private:
+		static std::string GetFileExtension(const std::string& filePath);
 		static std::string GetWorkingDirectory();
+		static std::string GetFullPath(const std::string& filePath);
+		static std::shared_ptr<const MeshGeometry> BuildPreview(const MESH_DATA& meshData, size_t maxFaces);
+		static RETURN_VALUE ParseMeshFile(const std::string& filePath, const std::string& fullPath, MESH_DATA& meshData, PLOAD_PROGRESS progress);
+		static std::shared_ptr<const MeshGeometry> LoadMeshGeometry(const std::string& filePath, const std::string& fullPath, PLOAD_PROGRESS progress);
 };
 
 #endif // !__UTILS_H__
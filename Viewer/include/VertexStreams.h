@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef __VERTEXSTREAMS_H__
+#define __VERTEXSTREAMS_H__
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <malloc.h>
+#include <new>
+#include <vector>
+#include "Constants.h"
+#include "Span.h"
+
+/*
+ * AlignedAllocator class.
+ * A std::allocator replacement handing out memory aligned to Alignment bytes, so vector data can be read
+ * with aligned SIMD loads.
+ */
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+	public:
+		typedef T value_type;
+
+		template <typename U>
+		struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+		AlignedAllocator() {}
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+		T* allocate(size_t count)
+		{
+			void* memory = _aligned_malloc(count * sizeof(T), Alignment);
+
+			if (!memory) {
+				throw std::bad_alloc();
+			}
+
+			return (T*) memory;
+		}
+
+		void deallocate(T* memory, size_t) { _aligned_free(memory); }
+
+		template <typename U>
+		bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float, SIMD_ALIGNMENT>> ALIGNED_FLOATS;
+
+// Positions or normals as separate coordinate arrays. The arrays are padded to a multiple of SIMD_FLOAT_WIDTH
+// with copies of the last element, so kernels may run whole SIMD blocks without a scalar tail.
+typedef struct _VERTEX_STREAMS_
+{
+	ALIGNED_FLOATS x;
+	ALIGNED_FLOATS y;
+	ALIGNED_FLOATS z;
+	size_t count;
+
+} VERTEX_STREAMS, *PVERTEX_STREAMS;
+
+/*
+ * VertexStreams class.
+ * Kernels over the structure of arrays layout of VERTEX_STREAMS. The loops only touch one coordinate array
+ * at a time, or read the three arrays at the same index, so the compiler turns them into packed SIMD code.
+ */
+class VertexStreams
+{
+	public:
+		static void Build(Span<const glm::vec3> vertices, VERTEX_STREAMS& streams);
+		static size_t GetPaddedCount(size_t count);
+		static size_t GetBytes(const VERTEX_STREAMS& streams);
+
+		// Writes the cartesian form of transformation * (x, y, z, 1) for every vertex into transformed[0, count)
+		static void Transform(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, glm::vec3* transformed);
+};
+
+#endif // !__VERTEXSTREAMS_H__
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * WorkerPool class.
+ * Threads kept alive between jobs, so a job which runs every frame does not pay for starting them. The thread
+ * calling Run() works on the job too, and tasks are handed out one at a time, so uneven tasks still balance.
+ */
+class WorkerPool
+{
+	private:
+		std::vector<std::thread> workers;
+		std::mutex jobMutex;
+		std::condition_variable jobCondition;
+		std::condition_variable doneCondition;
+
+		// The running job, replaced only once every worker is done with the one before
+		const std::function<void(size_t)>* task;
+		size_t taskCount;
+		std::atomic<size_t> nextTask;
+		size_t generation;
+		size_t finishedWorkers;
+		bool stopping;
+
+		void WorkerLoop();
+		void RunTasks(const std::function<void(size_t)>& job, size_t count);
+
+	public:
+		// threadCount counts the calling thread, 0 means one thread per core
+		WorkerPool(size_t threadCount = 0);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		size_t GetThreadCount() const { return workers.size() + 1; }
+
+		// Runs job(0) .. job(count - 1) and returns once all of them are done. Tasks may run in any order and at
+		// the same time, so each should only write its own results.
+		void Run(size_t count, const std::function<void(size_t)>& job);
+};
+
+#endif // !__WORKERPOOL_H__
@@ -0,0 +1,189 @@
+#include "GeometryStore.h"
+#include "MappedFile.h"
+#include "Constants.h"
+#include <cstring>
+#include <Windows.h>
+
+#define HASH_SEED							0x9E3779B97F4A7C15ull
+#define HASH_MULTIPLIER						0xFF51AFD7ED558CCDull
+#define HASH_FINALIZER						0xC4CEB9FE1A85EC53ull
+
+std::mutex GeometryStore::storeMutex;
+std::vector<GEOMETRY_ENTRY> GeometryStore::entries;
+
+uint64_t GeometryStore::HashContent(const char* data, size_t size)
+{
+	uint64_t hash = HASH_SEED ^ size;
+	uint64_t word;
+	size_t offset = 0;
+
+	// Mix whole 64 bit words, the file bytes are hashed at memory speed rather than byte by byte
+	for (; offset + sizeof(word) <= size; offset += sizeof(word)) {
+		memcpy(&word, data + offset, sizeof(word));
+		hash = (hash ^ word) * HASH_MULTIPLIER;
+		hash ^= hash >> 29;
+	}
+
+	if (offset < size) {
+		word = 0;
+		memcpy(&word, data + offset, size - offset);
+		hash = (hash ^ word) * HASH_MULTIPLIER;
+		hash ^= hash >> 29;
+	}
+
+	hash ^= hash >> 33;
+	hash *= HASH_FINALIZER;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+RETURN_VALUE GeometryStore::GetFileStamp(const std::string& filePath, uint64_t& fileSize, uint64_t& modifiedTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if (!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &attributes)) {
+		return IO_ERROR;
+	}
+
+	fileSize = ((uint64_t) attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	modifiedTime = ((uint64_t) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+	return SUCCESS;
+}
+
+bool GeometryStore::HashFile(GEOMETRY_KEY& key)
+{
+	uint64_t fileSize, modifiedTime;
+	MappedFile file;
+
+	if (GetFileStamp(key.filePath, fileSize, modifiedTime) != SUCCESS || fileSize != key.fileSize || modifiedTime != key.modifiedTime ||
+		file.Open(key.filePath) != SUCCESS || file.GetSize() != key.fileSize) {
+		return false;
+	}
+
+	key.contentHash = HashContent(file.GetData(), file.GetSize());
+	key.isHashed = true;
+
+	return true;
+}
+
+bool GeometryStore::IsSameSource(const GEOMETRY_KEY& first, const GEOMETRY_KEY& second)
+{
+	return first.filePath == second.filePath && first.fileSize == second.fileSize && first.modifiedTime == second.modifiedTime;
+}
+
+void GeometryStore::RemoveExpired()
+{
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->geometry.expired()) {
+			it = entries.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+}
+
+RETURN_VALUE GeometryStore::GetSourceKey(const std::string& filePath, GEOMETRY_KEY& key)
+{
+	key.filePath = filePath;
+	key.isHashed = false;
+	key.contentHash = 0;
+
+	return GetFileStamp(filePath, key.fileSize, key.modifiedTime);
+}
+
+std::shared_ptr<const MeshGeometry> GeometryStore::Find(GEOMETRY_KEY& key)
+{
+	std::vector<GEOMETRY_KEY> candidates;
+
+	{
+		std::lock_guard<std::mutex> lock(storeMutex);
+		RemoveExpired();
+
+		for each (const GEOMETRY_ENTRY& entry in entries)
+		{
+			// An unchanged file is shared without reading it at all
+			if (IsSameSource(entry.key, key)) {
+				std::shared_ptr<const MeshGeometry> geometry = entry.geometry.lock();
+
+				if (geometry) {
+					return geometry;
+				}
+			}
+
+			if (entry.key.fileSize == key.fileSize) {
+				candidates.push_back(entry.key);
+			}
+		}
+	}
+
+	// Contents of a size nobody else has are new, whatever they are
+	if (candidates.empty() || (!key.isHashed && !HashFile(key))) {
+		return nullptr;
+	}
+
+	// Files loaded while they had a unique size are hashed now, outside of the lock
+	for (GEOMETRY_KEY& candidate : candidates) {
+		if (!candidate.isHashed) {
+			HashFile(candidate);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(storeMutex);
+	std::shared_ptr<const MeshGeometry> found;
+
+	for (GEOMETRY_ENTRY& entry : entries)
+	{
+		for each (const GEOMETRY_KEY& candidate in candidates) {
+			if (candidate.isHashed && !entry.key.isHashed && IsSameSource(entry.key, candidate)) {
+				entry.key = candidate;
+			}
+		}
+
+		if (!found && entry.key.isHashed && entry.key.contentHash == key.contentHash && entry.key.fileSize == key.fileSize) {
+			found = entry.geometry.lock();
+		}
+	}
+
+	return found;
+}
+
+std::shared_ptr<const MeshGeometry> GeometryStore::Insert(const GEOMETRY_KEY& key, const std::shared_ptr<const MeshGeometry>& geometry)
+{
+	std::lock_guard<std::mutex> lock(storeMutex);
+	RemoveExpired();
+
+	// Another thread may have loaded the same file or contents in the meantime, its geometry wins
+	for each (const GEOMETRY_ENTRY& entry in entries)
+	{
+		bool isSameContent = key.isHashed && entry.key.isHashed && entry.key.contentHash == key.contentHash && entry.key.fileSize == key.fileSize;
+		std::shared_ptr<const MeshGeometry> existing = entry.geometry.lock();
+
+		if (existing && (isSameContent || IsSameSource(entry.key, key))) {
+			return existing;
+		}
+	}
+
+	GEOMETRY_ENTRY entry;
+	entry.key = key;
+	entry.geometry = geometry;
+	entries.push_back(entry);
+
+	return geometry;
+}
+
+size_t GeometryStore::GetGeometryCount()
+{
+	std::lock_guard<std::mutex> lock(storeMutex);
+	size_t count = 0;
+
+	for (auto& entry : entries) {
+		if (!entry.geometry.expired()) {
+			count++;
+		}
+	}
+
+	return count;
+}
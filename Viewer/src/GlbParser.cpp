@@ -0,0 +1,674 @@
+#include "GlbParser.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#define GLB_MAGIC							0x46546C67
+#define GLB_VERSION							2
+#define GLB_HEADER_SIZE						12
+#define GLB_CHUNK_HEADER_SIZE				8
+#define GLB_CHUNK_JSON						0x4E4F534A
+#define GLB_CHUNK_BIN						0x004E4942
+#define GLTF_TRIANGLES						4
+#define GLTF_BYTE							5120
+#define GLTF_UNSIGNED_BYTE					5121
+#define GLTF_SHORT							5122
+#define GLTF_UNSIGNED_SHORT					5123
+#define GLTF_UNSIGNED_INT					5125
+#define GLTF_FLOAT							5126
+#define JSON_MAX_DEPTH						64
+
+typedef enum _JSON_TYPE_ {
+
+	JSON_NULL = 0,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+
+} JSON_TYPE;
+
+typedef struct _JSON_VALUE_
+{
+	JSON_TYPE type;
+	double number;
+	std::string string;
+	std::vector<_JSON_VALUE_> array;
+	std::vector<std::pair<std::string, _JSON_VALUE_>> object;
+
+	_JSON_VALUE_() : type(JSON_NULL), number(0) {}
+
+	const _JSON_VALUE_* Get(const char* key) const
+	{
+		for (size_t i = 0; i < object.size(); i++) {
+			if (object[i].first == key) {
+				return &object[i].second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	const _JSON_VALUE_* At(double index) const
+	{
+		if (type != JSON_ARRAY || index < 0 || index >= array.size()) {
+			return nullptr;
+		}
+
+		return &array[(size_t) index];
+	}
+
+	double GetNumber(const char* key, double defaultValue) const
+	{
+		const _JSON_VALUE_* value = Get(key);
+		return value && value->type == JSON_NUMBER ? value->number : defaultValue;
+	}
+
+} JSON_VALUE, *PJSON_VALUE;
+
+// A typed array inside the binary chunk
+typedef struct _GLTF_ACCESSOR_VIEW_
+{
+	const char* data;
+	size_t count;
+	size_t stride;
+	int componentType;
+	int components;
+
+} GLTF_ACCESSOR_VIEW, *PGLTF_ACCESSOR_VIEW;
+
+typedef struct _GLTF_CONTEXT_
+{
+	const JSON_VALUE* gltf;
+	const char* binary;
+	size_t binarySize;
+	size_t primitiveCount;
+	size_t parsedPrimitives;
+	PLOAD_PROGRESS progress;
+
+} GLTF_CONTEXT, *PGLTF_CONTEXT;
+
+static const char* SkipWhitespace(const char* cursor, const char* end)
+{
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+		cursor++;
+	}
+
+	return cursor;
+}
+
+static bool ParseJsonString(const char*& cursor, const char* end, std::string& string)
+{
+	// cursor is on the opening quote
+	for (cursor++; cursor < end && *cursor != '"'; cursor++)
+	{
+		if (*cursor != '\\') {
+			string.push_back(*cursor);
+			continue;
+		}
+
+		if (++cursor == end) {
+			return false;
+		}
+
+		switch (*cursor)
+		{
+			case 'n': string.push_back('\n'); break;
+			case 't': string.push_back('\t'); break;
+			case 'r': string.push_back('\r'); break;
+			case 'b': string.push_back('\b'); break;
+			case 'f': string.push_back('\f'); break;
+			// Names we look up are plain ASCII, other code points are only kept as a placeholder
+			case 'u':
+				if (end - cursor < 5) {
+					return false;
+				}
+				cursor += 4;
+				string.push_back('?');
+				break;
+			default: string.push_back(*cursor); break;
+		}
+	}
+
+	if (cursor == end) {
+		return false;
+	}
+
+	cursor++;
+	return true;
+}
+
+static bool ParseJsonValue(const char*& cursor, const char* end, JSON_VALUE& value, int depth)
+{
+	cursor = SkipWhitespace(cursor, end);
+
+	if (cursor == end || depth > JSON_MAX_DEPTH) {
+		return false;
+	}
+
+	if (*cursor == '{')
+	{
+		value.type = JSON_OBJECT;
+		cursor = SkipWhitespace(cursor + 1, end);
+
+		if (cursor < end && *cursor == '}') {
+			cursor++;
+			return true;
+		}
+
+		while (cursor < end)
+		{
+			std::pair<std::string, JSON_VALUE> member;
+			cursor = SkipWhitespace(cursor, end);
+
+			if (cursor == end || *cursor != '"' || !ParseJsonString(cursor, end, member.first)) {
+				return false;
+			}
+
+			cursor = SkipWhitespace(cursor, end);
+
+			if (cursor == end || *cursor != ':' || !ParseJsonValue(++cursor, end, member.second, depth + 1)) {
+				return false;
+			}
+
+			value.object.push_back(std::move(member));
+			cursor = SkipWhitespace(cursor, end);
+
+			if (cursor < end && *cursor == ',') {
+				cursor++;
+			}
+			else if (cursor < end && *cursor == '}') {
+				cursor++;
+				return true;
+			}
+			else {
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	if (*cursor == '[')
+	{
+		value.type = JSON_ARRAY;
+		cursor = SkipWhitespace(cursor + 1, end);
+
+		if (cursor < end && *cursor == ']') {
+			cursor++;
+			return true;
+		}
+
+		while (cursor < end)
+		{
+			value.array.push_back(JSON_VALUE());
+
+			if (!ParseJsonValue(cursor, end, value.array.back(), depth + 1)) {
+				return false;
+			}
+
+			cursor = SkipWhitespace(cursor, end);
+
+			if (cursor < end && *cursor == ',') {
+				cursor++;
+			}
+			else if (cursor < end && *cursor == ']') {
+				cursor++;
+				return true;
+			}
+			else {
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	if (*cursor == '"') {
+		value.type = JSON_STRING;
+		return ParseJsonString(cursor, end, value.string);
+	}
+
+	if (end - cursor >= 4 && memcmp(cursor, "true", 4) == 0) {
+		value.type = JSON_BOOL;
+		value.number = 1;
+		cursor += 4;
+		return true;
+	}
+
+	if (end - cursor >= 5 && memcmp(cursor, "false", 5) == 0) {
+		value.type = JSON_BOOL;
+		cursor += 5;
+		return true;
+	}
+
+	if (end - cursor >= 4 && memcmp(cursor, "null", 4) == 0) {
+		cursor += 4;
+		return true;
+	}
+
+	// strtod needs a terminated string, numbers are short so copy the candidate characters
+	char number[64];
+	size_t length = 0;
+
+	while (cursor + length < end && length < sizeof(number) - 1 && strchr("+-0123456789.eE", cursor[length])) {
+		number[length] = cursor[length];
+		length++;
+	}
+
+	if (length == 0) {
+		return false;
+	}
+
+	number[length] = '\0';
+	value.type = JSON_NUMBER;
+	value.number = strtod(number, nullptr);
+	cursor += length;
+
+	return true;
+}
+
+static int GetComponentCount(const std::string& type)
+{
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+
+	return 0;
+}
+
+static size_t GetComponentSize(int componentType)
+{
+	switch (componentType)
+	{
+		case GLTF_BYTE: case GLTF_UNSIGNED_BYTE: return 1;
+		case GLTF_SHORT: case GLTF_UNSIGNED_SHORT: return 2;
+		case GLTF_UNSIGNED_INT: case GLTF_FLOAT: return 4;
+		default: return 0;
+	}
+}
+
+static bool GetAccessorView(const GLTF_CONTEXT& context, double accessorIndex, GLTF_ACCESSOR_VIEW& view)
+{
+	const JSON_VALUE* accessors = context.gltf->Get("accessors");
+	const JSON_VALUE* bufferViews = context.gltf->Get("bufferViews");
+	const JSON_VALUE* accessor = accessors ? accessors->At(accessorIndex) : nullptr;
+
+	// Sparse accessors and accessors without a view (all zeros) are not used by meshes worth supporting
+	if (!accessor || accessor->Get("sparse") || !bufferViews) {
+		return false;
+	}
+
+	const JSON_VALUE* bufferView = bufferViews->At(accessor->GetNumber("bufferView", -1));
+	const JSON_VALUE* type = accessor->Get("type");
+
+	// Only the binary chunk (buffer 0) is available, external buffers are not loaded
+	if (!bufferView || !type || type->type != JSON_STRING || bufferView->GetNumber("buffer", 0) != 0) {
+		return false;
+	}
+
+	view.componentType = (int) accessor->GetNumber("componentType", 0);
+	view.components = GetComponentCount(type->string);
+	view.count = (size_t) accessor->GetNumber("count", 0);
+
+	size_t elementSize = GetComponentSize(view.componentType) * view.components;
+	size_t viewOffset = (size_t) bufferView->GetNumber("byteOffset", 0);
+	size_t viewLength = (size_t) bufferView->GetNumber("byteLength", 0);
+	size_t accessorOffset = (size_t) accessor->GetNumber("byteOffset", 0);
+	view.stride = (size_t) bufferView->GetNumber("byteStride", (double) elementSize);
+
+	if (elementSize == 0 || view.stride < elementSize || viewOffset > context.binarySize || viewLength > context.binarySize - viewOffset) {
+		return false;
+	}
+
+	if (accessorOffset > viewLength) {
+		return false;
+	}
+
+	size_t available = viewLength - accessorOffset;
+
+	if (view.count > 0 && (available < elementSize || (available - elementSize) / view.stride < view.count - 1)) {
+		return false;
+	}
+
+	view.data = context.binary + viewOffset + accessorOffset;
+
+	return true;
+}
+
+// Appends vec3 float accessor data, tightly packed data is copied in one block
+static bool AppendVec3s(const GLTF_ACCESSOR_VIEW& view, std::vector<glm::vec3>& destination)
+{
+	if (view.componentType != GLTF_FLOAT || view.components != 3) {
+		return false;
+	}
+
+	size_t first = destination.size();
+	destination.resize(first + view.count);
+
+	if (view.stride == sizeof(glm::vec3)) {
+		memcpy(destination.data() + first, view.data, view.count * sizeof(glm::vec3));
+		return true;
+	}
+
+	for (size_t i = 0; i < view.count; i++) {
+		memcpy(&destination[first + i], view.data + i * view.stride, sizeof(glm::vec3));
+	}
+
+	return true;
+}
+
+static bool ReadIndices(const GLTF_ACCESSOR_VIEW& view, std::vector<uint32_t>& indices)
+{
+	if (view.components != 1) {
+		return false;
+	}
+
+	indices.resize(view.count);
+
+	if (view.componentType == GLTF_UNSIGNED_INT && view.stride == sizeof(uint32_t)) {
+		memcpy(indices.data(), view.data, view.count * sizeof(uint32_t));
+		return true;
+	}
+
+	for (size_t i = 0; i < view.count; i++)
+	{
+		const char* element = view.data + i * view.stride;
+
+		switch (view.componentType)
+		{
+			case GLTF_UNSIGNED_BYTE:	indices[i] = *(const uint8_t*) element; break;
+			case GLTF_UNSIGNED_SHORT:	{ uint16_t index; memcpy(&index, element, sizeof(index)); indices[i] = index; break; }
+			case GLTF_UNSIGNED_INT:		memcpy(&indices[i], element, sizeof(uint32_t)); break;
+			default:					return false;
+		}
+	}
+
+	return true;
+}
+
+static bool AppendPrimitive(GLTF_CONTEXT& context, const JSON_VALUE& primitive, const glm::mat4x4& transformation, bool isIdentity, MESH_DATA& meshData)
+{
+	const JSON_VALUE* attributes = primitive.Get("attributes");
+	GLTF_ACCESSOR_VIEW positions, normals, indexView;
+	std::vector<uint32_t> indices;
+
+	// Points, lines and strips are left out, only plain triangle lists are shown
+	if (primitive.GetNumber("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+		return true;
+	}
+
+	if (!attributes || !GetAccessorView(context, attributes->GetNumber("POSITION", -1), positions)) {
+		return false;
+	}
+
+	bool hasNormals = attributes->Get("NORMAL") != nullptr;
+
+	if (hasNormals && (!GetAccessorView(context, attributes->GetNumber("NORMAL", -1), normals) || normals.count != positions.count)) {
+		return false;
+	}
+
+	if (primitive.Get("indices")) {
+		if (!GetAccessorView(context, primitive.GetNumber("indices", -1), indexView) || !ReadIndices(indexView, indices)) {
+			return false;
+		}
+	}
+	else {
+		indices.resize(positions.count);
+
+		for (size_t i = 0; i < indices.size(); i++) {
+			indices[i] = (uint32_t) i;
+		}
+	}
+
+	size_t firstVertex = meshData.vertices.size();
+	size_t firstNormal = meshData.normals.size();
+
+	if (!AppendVec3s(positions, meshData.vertices) || (hasNormals && !AppendVec3s(normals, meshData.normals))) {
+		return false;
+	}
+
+	if (!isIdentity)
+	{
+		glm::mat4x4 normalTransformation = glm::transpose(glm::inverse(transformation));
+
+		for (size_t i = firstVertex; i < meshData.vertices.size(); i++) {
+			glm::vec4 vertex = transformation * glm::vec4(meshData.vertices[i], 1.0f);
+			meshData.vertices[i] = glm::vec3(vertex.x, vertex.y, vertex.z);
+		}
+
+		for (size_t i = firstNormal; i < meshData.normals.size(); i++) {
+			glm::vec4 normal = normalTransformation * glm::vec4(meshData.normals[i], 0.0f);
+			meshData.normals[i] = glm::normalize(glm::vec3(normal.x, normal.y, normal.z));
+		}
+	}
+
+	// glTF vertices already carry all of their attributes, so a normal index is the vertex index
+	size_t indexCount = indices.size() - indices.size() % FACE_ELEMENTS;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= positions.count) {
+			return false;
+		}
+
+		meshData.vertexIndices.push_back((int) (firstVertex + indices[i]));
+		meshData.normalIndices.push_back(hasNormals ? (int) (firstNormal + indices[i]) : -1);
+	}
+
+	return true;
+}
+
+static glm::mat4x4 GetNodeTransformation(const JSON_VALUE& node, bool& isIdentity)
+{
+	glm::mat4x4 transformation(I_MATRIX);
+	const JSON_VALUE* matrix = node.Get("matrix");
+	const JSON_VALUE* translation = node.Get("translation");
+	const JSON_VALUE* rotation = node.Get("rotation");
+	const JSON_VALUE* scale = node.Get("scale");
+
+	isIdentity = !matrix && !translation && !rotation && !scale;
+
+	// Matrices are stored column by column, like glm stores them
+	if (matrix && matrix->type == JSON_ARRAY && matrix->array.size() == 16) {
+		for (int column = 0; column < 4; column++) {
+			for (int row = 0; row < 4; row++) {
+				transformation[column][row] = (float) matrix->array[column * 4 + row].number;
+			}
+		}
+
+		return transformation;
+	}
+
+	if (rotation && rotation->type == JSON_ARRAY && rotation->array.size() == 4)
+	{
+		float x = (float) rotation->array[0].number;
+		float y = (float) rotation->array[1].number;
+		float z = (float) rotation->array[2].number;
+		float w = (float) rotation->array[3].number;
+
+		transformation[0] = glm::vec4(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0);
+		transformation[1] = glm::vec4(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0);
+		transformation[2] = glm::vec4(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0);
+	}
+
+	if (scale && scale->type == JSON_ARRAY && scale->array.size() == 3) {
+		for (int axis = 0; axis < 3; axis++) {
+			transformation[axis] *= (float) scale->array[axis].number;
+		}
+	}
+
+	if (translation && translation->type == JSON_ARRAY && translation->array.size() == 3) {
+		transformation[3] = glm::vec4((float) translation->array[0].number, (float) translation->array[1].number, (float) translation->array[2].number, 1);
+	}
+
+	return transformation;
+}
+
+static bool AppendMesh(GLTF_CONTEXT& context, double meshIndex, const glm::mat4x4& transformation, bool isIdentity, MESH_DATA& meshData)
+{
+	const JSON_VALUE* meshes = context.gltf->Get("meshes");
+	const JSON_VALUE* mesh = meshes ? meshes->At(meshIndex) : nullptr;
+	const JSON_VALUE* primitives = mesh ? mesh->Get("primitives") : nullptr;
+
+	if (!primitives || primitives->type != JSON_ARRAY) {
+		return false;
+	}
+
+	for (const JSON_VALUE& primitive : primitives->array)
+	{
+		if (context.progress)
+		{
+			context.progress->fraction = (float) context.parsedPrimitives / context.primitiveCount;
+
+			if (context.progress->cancelled) {
+				return false;
+			}
+		}
+
+		if (!AppendPrimitive(context, primitive, transformation, isIdentity, meshData)) {
+			return false;
+		}
+
+		context.parsedPrimitives++;
+	}
+
+	return true;
+}
+
+static bool AppendNode(GLTF_CONTEXT& context, double nodeIndex, const glm::mat4x4& parentTransformation, bool isParentIdentity, MESH_DATA& meshData, int depth)
+{
+	const JSON_VALUE* nodes = context.gltf->Get("nodes");
+	const JSON_VALUE* node = nodes ? nodes->At(nodeIndex) : nullptr;
+
+	// The depth limit also stops cycles in malformed node graphs
+	if (!node || depth > JSON_MAX_DEPTH) {
+		return false;
+	}
+
+	bool isIdentity;
+	glm::mat4x4 transformation = parentTransformation * GetNodeTransformation(*node, isIdentity);
+	isIdentity = isIdentity && isParentIdentity;
+
+	if (node->Get("mesh") && !AppendMesh(context, node->GetNumber("mesh", -1), transformation, isIdentity, meshData)) {
+		return false;
+	}
+
+	const JSON_VALUE* children = node->Get("children");
+
+	if (children && children->type == JSON_ARRAY) {
+		for (const JSON_VALUE& child : children->array) {
+			if (!AppendNode(context, child.number, transformation, isIdentity, meshData, depth + 1)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+RETURN_VALUE GlbParser::ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	MappedFile file;
+
+	if (file.Open(filePath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	return Parse(file.GetData(), file.GetEnd(), meshData, progress);
+}
+
+RETURN_VALUE GlbParser::Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	uint32_t header[3];
+	uint32_t chunk[2];
+	size_t size = end - begin;
+
+	if (size < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE) {
+		return FAILURE;
+	}
+
+	memcpy(header, begin, sizeof(header));
+	memcpy(chunk, begin + GLB_HEADER_SIZE, sizeof(chunk));
+
+	// The declared length is checked before the chunk length is taken from it, so the subtraction cannot wrap
+	if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION || header[2] > size || header[2] < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE ||
+		chunk[1] != GLB_CHUNK_JSON || chunk[0] > header[2] - GLB_HEADER_SIZE - GLB_CHUNK_HEADER_SIZE)
+	{
+		fprintf(stderr, "Only glTF 2.0 binary (.glb) files are supported\n");
+		return FAILURE;
+	}
+
+	end = begin + header[2];
+
+	JSON_VALUE gltf;
+	const char* json = begin + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+	const char* jsonEnd = json + chunk[0];
+
+	if (!ParseJsonValue(json, jsonEnd, gltf, 0) || gltf.type != JSON_OBJECT) {
+		return FAILURE;
+	}
+
+	GLTF_CONTEXT context = { &gltf, nullptr, 0, 0, 0, progress };
+
+	// The binary chunk is optional and follows the JSON chunk
+	if ((size_t) (end - jsonEnd) >= GLB_CHUNK_HEADER_SIZE)
+	{
+		memcpy(chunk, jsonEnd, sizeof(chunk));
+
+		if (chunk[1] == GLB_CHUNK_BIN && chunk[0] <= (size_t) (end - jsonEnd) - GLB_CHUNK_HEADER_SIZE) {
+			context.binary = jsonEnd + GLB_CHUNK_HEADER_SIZE;
+			context.binarySize = chunk[0];
+		}
+	}
+
+	const JSON_VALUE* meshes = gltf.Get("meshes");
+
+	if (meshes && meshes->type == JSON_ARRAY) {
+		for (const JSON_VALUE& mesh : meshes->array) {
+			const JSON_VALUE* primitives = mesh.Get("primitives");
+			context.primitiveCount += primitives ? primitives->array.size() : 0;
+		}
+	}
+
+	const JSON_VALUE* scenes = gltf.Get("scenes");
+	const JSON_VALUE* scene = scenes ? scenes->At(gltf.GetNumber("scene", 0)) : nullptr;
+	const JSON_VALUE* sceneNodes = scene ? scene->Get("nodes") : nullptr;
+	glm::mat4x4 identity(I_MATRIX);
+
+	if (sceneNodes && sceneNodes->type == JSON_ARRAY) {
+		for (const JSON_VALUE& node : sceneNodes->array) {
+			if (!AppendNode(context, node.number, identity, true, meshData, 0)) {
+				return FAILURE;
+			}
+		}
+	}
+	else if (meshes) {
+		// Without a scene there is no placement either, so every mesh is shown as it is
+		for (size_t i = 0; i < meshes->array.size(); i++) {
+			if (!AppendMesh(context, (double) i, identity, true, meshData)) {
+				return FAILURE;
+			}
+		}
+	}
+
+	bool hasNormals = false;
+
+	for each (int normalIndex in meshData.normalIndices) {
+		if (normalIndex >= 0) {
+			hasNormals = true;
+			break;
+		}
+	}
+
+	if (!hasNormals) {
+		meshData.normalIndices.clear();
+	}
+
+	return meshData.vertexIndices.empty() ? FAILURE : SUCCESS;
+}
@@ -3,6 +3,8 @@
 
 #include "ImguiMenus.h"
 #include "MeshModel.h"
+#include "ModelLoader.h"
+#include "TransformKernels.h"
 #include "Utils.h"
 #include "Constants.h"
 #include <cmath>
@@ -13,6 +15,7 @@
 #include <stdlib.h>
 #include <nfd.h>
 #include <random>
+#include <set>
 #include <GLFW/glfw3.h>
 
 bool showDemoWindow = false;
@@ -21,6 +24,9 @@ bool modelControlWindow = false;
 
 glm::vec4 clearColor = glm::vec4(0.8f, 0.8f, 0.8f, 1.00f);
 
+// Models chosen in "Load Model..." are loaded in the background, so the menus keep running meanwhile
+ModelLoader modelLoader;
+
 const glm::vec4& GetClearColor()
 {
 	return clearColor;
@@ -28,6 +34,12 @@ const glm::vec4& GetClearColor()
 
 void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 {
+	// Hand over the models that finished loading since the last frame
+	if (modelLoader.Poll(scene) > 0)
+	{
+		modelControlWindow = true;
+	}
+
 	// 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
 	if (showDemoWindow)
 	{
@@ -70,12 +82,66 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 			modelControlWindow = true;
 		}
 
+		static int sphereTessellation = SPHERE_DEFAULT_TESSELLATION;
+		ImGui::SliderInt("Sphere tessellation", &sphereTessellation, 0, SPHERE_MAX_TESSELLATION);
+
 		if (ImGui::Button("Add Sphere model"))
 		{
-			scene->AddPrimitiveModel(SPHERE);
+			scene->AddPrimitiveModel(SPHERE, sphereTessellation);
+			modelControlWindow = true;
+		}
+
+		static int primitivesCount = 100;
+		ImGui::InputInt("Models count", &primitivesCount);
+		primitivesCount = primitivesCount < 1 ? 1 : primitivesCount;
+
+		if (ImGui::Button("Add Cube models"))
+		{
+			scene->AddPrimitiveModels(CUBE, primitivesCount);
+			modelControlWindow = true;
+		}
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Add Sphere models"))
+		{
+			scene->AddPrimitiveModels(SPHERE, primitivesCount, sphereTessellation);
+			modelControlWindow = true;
+		}
+
+		// One model holding all the copies, instead of one model per copy
+		if (ImGui::Button("Add Cube instances"))
+		{
+			scene->AddPrimitiveInstances(CUBE, primitivesCount);
 			modelControlWindow = true;
 		}
 
+		ImGui::SameLine();
+
+		if (ImGui::Button("Add Sphere instances"))
+		{
+			scene->AddPrimitiveInstances(SPHERE, primitivesCount, sphereTessellation);
+			modelControlWindow = true;
+		}
+
+
+		ImGui::Text("---------------- Paged Models: ----------------");
+
+		// The budget applies to each paged model on its own
+		static int pagedBudget = PAGED_MESH_DEFAULT_BUDGET_MB;
+		ImGui::SliderInt("Memory budget (MB)", &pagedBudget, 16, 4096);
+
+		for each (auto model in scene->GetModels())
+		{
+			std::shared_ptr<PagedMeshModel> pagedModel = std::dynamic_pointer_cast<PagedMeshModel>(model);
+
+			if (pagedModel) {
+				const std::shared_ptr<PagedMesh>& pagedMesh = pagedModel->GetPagedMesh();
+				pagedMesh->SetByteBudget((uint64_t) pagedBudget << 20);
+				ImGui::Text("%s: %u / %u chunks, %.1f MB resident", pagedModel->GetModelName().c_str(),
+					(unsigned int) pagedMesh->GetResidentChunkCount(), (unsigned int) pagedMesh->GetChunkCount(), pagedMesh->GetResidentBytes() / 1048576.0);
+			}
+		}
 
 		ImGui::Text("------------------- Cameras: -------------------");
 
@@ -357,6 +423,68 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 		}
 		ImGui::Text("Active model: %d", scene->GetActiveModelIndex());
 
+		// Ctrl + click picks the model under the mouse, mapped back the way Renderer::ToViewPlane maps points to pixels
+		static int pickedModel = DISABLED;
+		static int pickedFace = DISABLED;
+
+		if (io.KeyCtrl && ImGui::IsMouseClicked(0) && !ImGui::IsMouseHoveringAnyWindow())
+		{
+			glm::vec2 viewPoint((io.MousePos.x - io.DisplaySize.x / 2.0f) / SCREEN_SCALE, (io.DisplaySize.y / 2.0f - io.MousePos.y) / SCREEN_SCALE);
+			pickedModel = scene->PickModel(viewPoint, pickedFace);
+		}
+
+		if (pickedModel != DISABLED) {
+			ImGui::Text("Picked model %d, face %d (Ctrl + click)", pickedModel, pickedFace);
+		}
+		else {
+			ImGui::Text("Ctrl + click a model to pick it");
+		}
+
+		// Geometry is shared between models, so the scene total counts every distinct geometry once
+		std::set<const MeshGeometry*> countedGeometries;
+		size_t sceneBytes = 0;
+
+		for each (auto model in scene->GetModels())
+		{
+			if (countedGeometries.insert(model->GetGeometry().get()).second) {
+				sceneBytes += model->GetGeometry()->GetMemoryUsage().totalBytes;
+			}
+		}
+
+		int activeModelIndex = scene->GetActiveModelIndex();
+
+		if (activeModelIndex != DISABLED && activeModelIndex < (int) scene->GetModels().size())
+		{
+			const std::shared_ptr<MeshModel>& activeModel = scene->GetModels()[activeModelIndex];
+			const std::shared_ptr<const MeshGeometry>& geometry = activeModel->GetGeometry();
+			std::shared_ptr<InstancedMeshModel> instancedModel = std::dynamic_pointer_cast<InstancedMeshModel>(activeModel);
+			MESH_MEMORY memory = geometry->GetMemoryUsage();
+
+			if (activeModel->GetLods()) {
+				ImGui::Text("Level of detail: %u of %u built", (unsigned int) activeModel->GetLodLevel(), (unsigned int) activeModel->GetLods()->GetLevelCount());
+			}
+
+			if (instancedModel) {
+				ImGui::Text("Instances: %u (%.2f MB)", (unsigned int) instancedModel->GetInstances().size(),
+					instancedModel->GetInstances().capacity() * sizeof(MODEL_INSTANCE) / 1048576.0);
+			}
+
+			ImGui::Text("Model memory: %.2f MB, shared by %d models", memory.totalBytes / 1048576.0, (int) geometry.use_count());
+			ImGui::Text("  positions %.2f MB, normals %.2f MB, texture %.2f MB, indices %.2f MB, x/y/z arrays %.2f MB",
+				memory.vertexBytes / 1048576.0, memory.normalBytes / 1048576.0, memory.textureBytes / 1048576.0, memory.indexBytes / 1048576.0,
+				memory.streamBytes / 1048576.0);
+			ImGui::Text("  hierarchy %.2f MB", memory.bvhBytes / 1048576.0);
+		}
+
+		ImGui::Text("Scene geometry memory: %.2f MB", sceneBytes / 1048576.0);
+
+		const CULLING_STATS& cullingStats = scene->GetCullingStats();
+		ImGui::Text("Models in view: %u, culled: %u", (unsigned int) cullingStats.visibleModels, (unsigned int) cullingStats.culledModels);
+
+		if (cullingStats.visibleInstances + cullingStats.culledInstances > 0) {
+			ImGui::Text("Instances in view: %u, culled: %u", (unsigned int) cullingStats.visibleInstances, (unsigned int) cullingStats.culledInstances);
+		}
+
 		static glm::mat4x4 activeModelWorldTransformation = scene->GetActiveModelTransformation();
 		std::string sModelTransform = "";
 		for (int i = 0; i < 4; i++)
@@ -388,14 +516,30 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 		static bool ShowVerticesNormals = false;
 		static bool ShowFacesNormals = false;
 		static bool ShowBorderCube = false;
+		static bool UseVertexStreams = false;
+		static bool UseLevelOfDetail = true;
+		static bool UseTiledRasterizer = true;
+		static int RenderMode = RENDER_WIREFRAME;
 
 		scene->ShowVerticesNormals(ShowVerticesNormals);
 		scene->ShowFacesNormals(ShowFacesNormals);
 		scene->ShowBorderCube(ShowBorderCube);
+		scene->UseVertexStreams(UseVertexStreams);
+		scene->UseLevelOfDetail(UseLevelOfDetail);
+		scene->UseTiledRasterizer(UseTiledRasterizer);
+		scene->SetRenderMode((RENDER_MODE) RenderMode);
 
+		ImGui::RadioButton("Wireframe", &RenderMode, RENDER_WIREFRAME);
+		ImGui::SameLine();
+		ImGui::RadioButton("Solid (z-buffer)", &RenderMode, RENDER_SOLID);
 		ImGui::Checkbox("Show vertices normals", &ShowVerticesNormals);
 		ImGui::Checkbox("Show face normals", &ShowFacesNormals);
 		ImGui::Checkbox("Show Border Cube", &ShowBorderCube);
+		ImGui::Checkbox("Transform from x/y/z arrays (SoA)", &UseVertexStreams);
+		ImGui::SameLine();
+		ImGui::Text("(%s kernel)", TransformKernels::GetKernelName(TransformKernels::GetBestKernel()));
+		ImGui::Checkbox("Level of detail by screen size", &UseLevelOfDetail);
+		ImGui::Checkbox("Rasterize screen tiles on all cores", &UseTiledRasterizer);
 
 		//Model moves:
 
@@ -464,7 +608,35 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 		}
 	}
 
-	// 4. Demonstrate creating a fullscreen menu bar and populating it.
+	// 4. Show the models which are still loading.
+	if (!modelLoader.GetRequests().empty())
+	{
+		ImGui::Begin("Loading models");
+
+		for each (auto request in modelLoader.GetRequests())
+		{
+			// The same file may be loading more than once, so the widgets are told apart by their request
+			ImGui::PushID(request.get());
+			ImGui::Text("%s", request->GetFilePath().c_str());
+			ImGui::ProgressBar(request->GetProgress());
+			ImGui::SameLine();
+
+			if (request->IsCancelled())
+			{
+				ImGui::Text("Cancelling...");
+			}
+			else if (ImGui::Button("Cancel"))
+			{
+				request->Cancel();
+			}
+
+			ImGui::PopID();
+		}
+
+		ImGui::End();
+	}
+
+	// 5. Demonstrate creating a fullscreen menu bar and populating it.
 	{
 		ImGuiWindowFlags flags = ImGuiWindowFlags_NoFocusOnAppearing;
 		if (ImGui::BeginMainMenuBar())
@@ -474,10 +646,9 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 				if (ImGui::MenuItem("Load Model...", "CTRL+O"))
 				{
 					nfdchar_t *outPath = NULL;
-					nfdresult_t result = NFD_OpenDialog("obj;png,jpg", NULL, &outPath);
+					nfdresult_t result = NFD_OpenDialog("obj,ply,stl,glb;png,jpg", NULL, &outPath);
 					if (result == NFD_OKAY) {
-						scene->AddModel(std::make_shared<MeshModel>(Utils::LoadMeshModel(outPath)));
-						modelControlWindow = true;
+						modelLoader.Load(outPath);
 						free(outPath);
 					}
 					else if (result == NFD_CANCEL) {
@@ -486,6 +657,15 @@ void DrawImguiMenus(ImGuiIO& io, Scene* scene)
 					}
 
 				}
+				if (ImGui::MenuItem("Load Paged Model..."))
+				{
+					nfdchar_t *outPath = NULL;
+					nfdresult_t result = NFD_OpenDialog("obj,ply,stl,glb", NULL, &outPath);
+					if (result == NFD_OKAY) {
+						modelLoader.Load(outPath, true);
+						free(outPath);
+					}
+				}
 				ImGui::EndMenu();
 			}
 			ImGui::EndMainMenuBar();
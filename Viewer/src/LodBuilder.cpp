@@ -0,0 +1,162 @@
+#include "LodBuilder.h"
+#include "MeshSimplifier.h"
+#include "Constants.h"
+#include <iterator>
+
+// LodChain implementation
+
+void LodChain::AddLevel(const std::shared_ptr<const MeshGeometry>& level)
+{
+	std::lock_guard<std::mutex> lock(levelsMutex);
+	levels.push_back(level);
+}
+
+size_t LodChain::GetLevelCount() const
+{
+	std::lock_guard<std::mutex> lock(levelsMutex);
+	return levels.size();
+}
+
+std::shared_ptr<const MeshGeometry> LodChain::Select(const std::shared_ptr<const MeshGeometry>& base, size_t maxFaceCount, size_t& level) const
+{
+	level = 0;
+
+	if (base->GetIndexBuffer().size() / FACE_ELEMENTS <= maxFaceCount) {
+		return base;
+	}
+
+	std::lock_guard<std::mutex> lock(levelsMutex);
+
+	for (size_t i = 0; i < levels.size(); i++) {
+		level = i + 1;
+
+		if (levels[i]->GetIndexBuffer().size() / FACE_ELEMENTS <= maxFaceCount) {
+			break;
+		}
+	}
+
+	return level == 0 ? base : levels[level - 1];
+}
+
+// LodBuilder implementation
+
+LodBuilder::LodBuilder() : stopping(false)
+{
+
+}
+
+LodBuilder::~LodBuilder()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+
+	queueCondition.notify_all();
+
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+LodBuilder& LodBuilder::GetInstance()
+{
+	static LodBuilder instance;
+	return instance;
+}
+
+std::shared_ptr<LodChain> LodBuilder::Request(const std::shared_ptr<const MeshGeometry>& geometry)
+{
+	if (!geometry || geometry->GetIndexBuffer().size() / FACE_ELEMENTS < LOD_MIN_FACES * LOD_REDUCTION) {
+		return nullptr;
+	}
+
+	LodBuilder& builder = GetInstance();
+	std::shared_ptr<LodChain> chain;
+
+	{
+		std::lock_guard<std::mutex> lock(builder.queueMutex);
+		std::weak_ptr<LodChain>& entry = builder.chains[geometry.get()];
+		chain = entry.lock();
+
+		if (chain) {
+			return chain;
+		}
+
+		// Forget chains whose models are all gone, their geometry address may be reused by now
+		for (auto it = builder.chains.begin(); it != builder.chains.end();) {
+			it = it->second.expired() && it->first != geometry.get() ? builder.chains.erase(it) : std::next(it);
+		}
+
+		chain = std::make_shared<LodChain>();
+		entry = chain;
+
+		LOD_REQUEST request;
+		request.geometry = geometry;
+		request.chain = chain;
+		builder.queue.push_back(request);
+
+		// The worker is only started once something has to be simplified
+		if (!builder.worker.joinable()) {
+			builder.worker = std::thread(&LodBuilder::WorkerLoop, &builder);
+		}
+	}
+
+	builder.queueCondition.notify_one();
+
+	return chain;
+}
+
+void LodBuilder::WorkerLoop()
+{
+	while (true)
+	{
+		LOD_REQUEST request;
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+			if (stopping) {
+				return;
+			}
+
+			request = queue.front();
+			queue.pop_front();
+		}
+
+		BuildChain(request);
+	}
+}
+
+void LodBuilder::BuildChain(LOD_REQUEST& request)
+{
+	std::shared_ptr<const MeshGeometry> previous = request.geometry;
+	size_t previousFaces = previous->GetIndexBuffer().size() / FACE_ELEMENTS;
+
+	// Every level is simplified from the one before, which is smaller and already close to the result
+	for (int level = 0; level < LOD_MAX_LEVELS && previousFaces >= LOD_MIN_FACES * LOD_REDUCTION; level++)
+	{
+		if (request.chain.expired()) {
+			return;
+		}
+
+		std::shared_ptr<const MeshGeometry> simplified = MeshSimplifier::Simplify(*previous, previousFaces / LOD_REDUCTION, &stopping);
+		std::shared_ptr<LodChain> chain = request.chain.lock();
+
+		if (!simplified || !chain) {
+			return;
+		}
+
+		size_t simplifiedFaces = simplified->GetIndexBuffer().size() / FACE_ELEMENTS;
+
+		// A surface that cannot be simplified much further ends the chain
+		if (simplifiedFaces * 2 > previousFaces) {
+			return;
+		}
+
+		chain->AddLevel(simplified);
+		previous = simplified;
+		previousFaces = simplifiedFaces;
+	}
+}
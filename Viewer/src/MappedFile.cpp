@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+#include <Windows.h>
+
+MappedFile::MappedFile() :
+	fileHandle(nullptr),
+	mappingHandle(nullptr),
+	data(nullptr),
+	size(0)
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+RETURN_VALUE MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return IO_ERROR;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return IO_ERROR;
+	}
+
+	fileHandle = file;
+	size = (size_t) fileSize.QuadPart;
+
+	// Empty files cannot be mapped, but they are still valid (and empty) inputs
+	if (size == 0) {
+		return SUCCESS;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping == NULL) {
+		Close();
+		return IO_ERROR;
+	}
+
+	mappingHandle = mapping;
+	data = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (data == NULL) {
+		Close();
+		return IO_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+void MappedFile::Close()
+{
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+
+	if (mappingHandle) {
+		CloseHandle((HANDLE) mappingHandle);
+	}
+
+	if (fileHandle) {
+		CloseHandle((HANDLE) fileHandle);
+	}
+
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,365 @@
+#include "MeshBvh.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+#define BVH_BINS							16
+// Leaves are made as soon as a node has this few faces, and always before it has more than the maximum
+#define BVH_LEAF_TRIANGLES					4
+#define BVH_MAX_LEAF_TRIANGLES				16
+// Deeper nodes become leaves, which bounds the traversal stacks below
+#define BVH_MAX_DEPTH						48
+#define BVH_STACK_SIZE						64
+
+static float GetHalfArea(const glm::vec3& minCoordinates, const glm::vec3& maxCoordinates)
+{
+	glm::vec3 extent = maxCoordinates - minCoordinates;
+	return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+// Distance along the ray at which it enters the box, or -1 when it misses the box within [0, maxDistance]
+static float GetBoxEntry(const BVH_NODE& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+{
+	float entry = 0;
+	float exit = maxDistance;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float first = (node.minCoordinates[axis] - origin[axis]) * inverseDirection[axis];
+		float second = (node.maxCoordinates[axis] - origin[axis]) * inverseDirection[axis];
+
+		// fmin and fmax drop the NaN of a ray running exactly along a box side
+		entry = fmax(entry, fmin(first, second));
+		exit = fmin(exit, fmax(first, second));
+	}
+
+	return entry <= exit ? entry : -1;
+}
+
+void MeshBvh::Build(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices)
+{
+	uint32_t faceCount = (uint32_t) (indices.size() / FACE_ELEMENTS);
+
+	nodes.clear();
+	faces.resize(faceCount);
+
+	if (faceCount == 0) {
+		return;
+	}
+
+	std::vector<glm::vec3> faceMin(faceCount);
+	std::vector<glm::vec3> faceMax(faceCount);
+	std::vector<glm::vec3> centroids(faceCount);
+
+	for (uint32_t face = 0; face < faceCount; face++) {
+		const glm::vec3& p1 = vertices[indices[face * 3]];
+		const glm::vec3& p2 = vertices[indices[face * 3 + 1]];
+		const glm::vec3& p3 = vertices[indices[face * 3 + 2]];
+
+		faceMin[face] = glm::min(glm::min(p1, p2), p3);
+		faceMax[face] = glm::max(glm::max(p1, p2), p3);
+		centroids[face] = (faceMin[face] + faceMax[face]) * 0.5f;
+		faces[face] = face;
+	}
+
+	nodes.reserve(2 * faceCount / BVH_LEAF_TRIANGLES + 1);
+	BuildNode(faceMin, faceMax, centroids, 0, faceCount, 0);
+	nodes.shrink_to_fit();
+}
+
+uint32_t MeshBvh::BuildNode(const std::vector<glm::vec3>& faceMin, const std::vector<glm::vec3>& faceMax, const std::vector<glm::vec3>& centroids, uint32_t begin, uint32_t end, int depth)
+{
+	uint32_t nodeIndex = (uint32_t) nodes.size();
+	uint32_t count = end - begin;
+	glm::vec3 boundsMin = faceMin[faces[begin]];
+	glm::vec3 boundsMax = faceMax[faces[begin]];
+	glm::vec3 centroidMin = centroids[faces[begin]];
+	glm::vec3 centroidMax = centroids[faces[begin]];
+
+	for (uint32_t i = begin + 1; i < end; i++) {
+		boundsMin = glm::min(boundsMin, faceMin[faces[i]]);
+		boundsMax = glm::max(boundsMax, faceMax[faces[i]]);
+		centroidMin = glm::min(centroidMin, centroids[faces[i]]);
+		centroidMax = glm::max(centroidMax, centroids[faces[i]]);
+	}
+
+	BVH_NODE node;
+	node.minCoordinates = boundsMin;
+	node.maxCoordinates = boundsMax;
+	node.offset = begin;
+	node.triangleCount = count;
+	nodes.push_back(node);
+
+	if (count <= BVH_LEAF_TRIANGLES || depth >= BVH_MAX_DEPTH) {
+		return nodeIndex;
+	}
+
+	// Splitting pays off when visiting the node plus both children is cheaper than testing every face
+	float parentArea = GetHalfArea(boundsMin, boundsMax);
+	float bestCost = parentArea * count;
+	int bestAxis = -1;
+	int bestSplit = 0;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = centroidMax[axis] - centroidMin[axis];
+
+		if (extent <= 0) {
+			continue;
+		}
+
+		uint32_t binCount[BVH_BINS] = { 0 };
+		glm::vec3 binMin[BVH_BINS];
+		glm::vec3 binMax[BVH_BINS];
+
+		for (uint32_t i = begin; i < end; i++) {
+			int bin = (int) ((centroids[faces[i]][axis] - centroidMin[axis]) * BVH_BINS / extent);
+			bin = bin < BVH_BINS ? bin : BVH_BINS - 1;
+
+			binMin[bin] = binCount[bin] == 0 ? faceMin[faces[i]] : glm::min(binMin[bin], faceMin[faces[i]]);
+			binMax[bin] = binCount[bin] == 0 ? faceMax[faces[i]] : glm::max(binMax[bin], faceMax[faces[i]]);
+			binCount[bin]++;
+		}
+
+		// Sweep from the right to get the right side of every split, then from the left to price them
+		float rightArea[BVH_BINS];
+		uint32_t rightCount[BVH_BINS];
+		glm::vec3 sideMin, sideMax;
+		uint32_t sideCount = 0;
+
+		for (int bin = BVH_BINS - 1; bin > 0; bin--) {
+			if (binCount[bin] > 0) {
+				sideMin = sideCount == 0 ? binMin[bin] : glm::min(sideMin, binMin[bin]);
+				sideMax = sideCount == 0 ? binMax[bin] : glm::max(sideMax, binMax[bin]);
+				sideCount += binCount[bin];
+			}
+
+			rightArea[bin] = sideCount > 0 ? GetHalfArea(sideMin, sideMax) : 0;
+			rightCount[bin] = sideCount;
+		}
+
+		sideCount = 0;
+
+		for (int split = 1; split < BVH_BINS; split++) {
+			if (binCount[split - 1] > 0) {
+				sideMin = sideCount == 0 ? binMin[split - 1] : glm::min(sideMin, binMin[split - 1]);
+				sideMax = sideCount == 0 ? binMax[split - 1] : glm::max(sideMax, binMax[split - 1]);
+				sideCount += binCount[split - 1];
+			}
+
+			if (sideCount == 0 || rightCount[split] == 0) {
+				continue;
+			}
+
+			float cost = parentArea + GetHalfArea(sideMin, sideMax) * sideCount + rightArea[split] * rightCount[split];
+
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	uint32_t middle = begin;
+
+	if (bestAxis >= 0) {
+		float axisMin = centroidMin[bestAxis];
+		float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+
+		middle = (uint32_t) (std::partition(faces.begin() + begin, faces.begin() + end, [&](uint32_t face) {
+			int bin = (int) ((centroids[face][bestAxis] - axisMin) * BVH_BINS / extent);
+			return (bin < BVH_BINS ? bin : BVH_BINS - 1) < bestSplit;
+		}) - faces.begin());
+	}
+	else if (count > BVH_MAX_LEAF_TRIANGLES) {
+		// No split is worth it by the heuristic, but the leaf would be too large: halve along the longest axis
+		glm::vec3 extent = centroidMax - centroidMin;
+		int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		middle = begin + count / 2;
+
+		std::nth_element(faces.begin() + begin, faces.begin() + middle, faces.begin() + end, [&](uint32_t left, uint32_t right) {
+			return centroids[left][axis] < centroids[right][axis];
+		});
+	}
+
+	if (middle == begin || middle == end) {
+		return nodeIndex;
+	}
+
+	BuildNode(faceMin, faceMax, centroids, begin, middle, depth + 1);
+	uint32_t rightIndex = BuildNode(faceMin, faceMax, centroids, middle, end, depth + 1);
+
+	nodes[nodeIndex].offset = rightIndex;
+	nodes[nodeIndex].triangleCount = 0;
+
+	return nodeIndex;
+}
+
+bool MeshBvh::Intersect(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BVH_HIT& hit) const
+{
+	if (nodes.empty()) {
+		return false;
+	}
+
+	glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	uint32_t stack[BVH_STACK_SIZE];
+	float stackEntry[BVH_STACK_SIZE];
+	int stackSize = 0;
+	bool isHit = false;
+
+	float rootEntry = GetBoxEntry(nodes[0], origin, inverseDirection, maxDistance);
+
+	if (rootEntry < 0) {
+		return false;
+	}
+
+	stack[stackSize] = 0;
+	stackEntry[stackSize++] = rootEntry;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		uint32_t nodeIndex = stack[stackSize];
+
+		// A closer hit may have been found since the node was pushed
+		if (stackEntry[stackSize] > maxDistance) {
+			continue;
+		}
+
+		const BVH_NODE& node = nodes[nodeIndex];
+
+		if (node.triangleCount > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.triangleCount; i++) {
+				// Moller-Trumbore ray triangle intersection
+				const glm::vec3& p1 = vertices[indices[faces[i] * 3]];
+				glm::vec3 edge1 = vertices[indices[faces[i] * 3 + 1]] - p1;
+				glm::vec3 edge2 = vertices[indices[faces[i] * 3 + 2]] - p1;
+				glm::vec3 p = glm::cross(direction, edge2);
+				float determinant = glm::dot(edge1, p);
+
+				if (determinant == 0) {
+					continue;
+				}
+
+				glm::vec3 s = origin - p1;
+				float u = glm::dot(s, p) / determinant;
+				glm::vec3 q = glm::cross(s, edge1);
+				float v = glm::dot(direction, q) / determinant;
+				float distance = glm::dot(edge2, q) / determinant;
+
+				if (u >= 0 && v >= 0 && u + v <= 1 && distance >= 0 && distance <= maxDistance) {
+					maxDistance = distance;
+					hit.distance = distance;
+					hit.face = faces[i];
+					isHit = true;
+				}
+			}
+
+			continue;
+		}
+
+		// Push the farther child first, so the nearer one is searched first and shortens the ray for the other
+		uint32_t left = nodeIndex + 1;
+		uint32_t right = node.offset;
+		float leftEntry = GetBoxEntry(nodes[left], origin, inverseDirection, maxDistance);
+		float rightEntry = GetBoxEntry(nodes[right], origin, inverseDirection, maxDistance);
+
+		if (leftEntry >= 0 && rightEntry >= 0 && leftEntry < rightEntry) {
+			std::swap(left, right);
+			std::swap(leftEntry, rightEntry);
+		}
+
+		if (leftEntry >= 0) {
+			stack[stackSize] = left;
+			stackEntry[stackSize++] = leftEntry;
+		}
+
+		if (rightEntry >= 0) {
+			stack[stackSize] = right;
+			stackEntry[stackSize++] = rightEntry;
+		}
+	}
+
+	return isHit;
+}
+
+VOLUME_TEST MeshBvh::TestBox(const glm::vec4 planes[], int planeCount, const glm::vec3& minCoordinates, const glm::vec3& maxCoordinates)
+{
+	bool isInside = true;
+
+	for (int i = 0; i < planeCount; i++) {
+		const glm::vec4& plane = planes[i];
+
+		// The corner farthest along the plane normal decides if anything is inside, the nearest one if everything is
+		glm::vec3 farthest(plane.x >= 0 ? maxCoordinates.x : minCoordinates.x, plane.y >= 0 ? maxCoordinates.y : minCoordinates.y, plane.z >= 0 ? maxCoordinates.z : minCoordinates.z);
+		glm::vec3 nearest(plane.x >= 0 ? minCoordinates.x : maxCoordinates.x, plane.y >= 0 ? minCoordinates.y : maxCoordinates.y, plane.z >= 0 ? minCoordinates.z : maxCoordinates.z);
+
+		if (plane.x * farthest.x + plane.y * farthest.y + plane.z * farthest.z + plane.w < 0) {
+			return VOLUME_OUTSIDE;
+		}
+
+		if (plane.x * nearest.x + plane.y * nearest.y + plane.z * nearest.z + plane.w < 0) {
+			isInside = false;
+		}
+	}
+
+	return isInside ? VOLUME_INSIDE : VOLUME_PARTIAL;
+}
+
+VOLUME_TEST MeshBvh::QueryFrustum(const glm::mat4x4& transformation, std::vector<uint32_t>& visibleFaces) const
+{
+	if (nodes.empty()) {
+		return VOLUME_OUTSIDE;
+	}
+
+	// Planes of the clip space volume in model coordinates (Gribb and Hartmann): w + x, w - x, w + y, w - y and w
+	glm::vec4 rows[4];
+
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(transformation[0][i], transformation[1][i], transformation[2][i], transformation[3][i]);
+	}
+
+	const glm::vec4 planes[5] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[3] };
+	VOLUME_TEST rootTest = TestBox(planes, 5, nodes[0].minCoordinates, nodes[0].maxCoordinates);
+
+	if (rootTest != VOLUME_PARTIAL) {
+		return rootTest;
+	}
+
+	// Subtrees found completely inside are collected without testing their nodes again
+	uint32_t stack[BVH_STACK_SIZE];
+	bool stackInside[BVH_STACK_SIZE];
+	int stackSize = 0;
+
+	stack[stackSize] = 0;
+	stackInside[stackSize++] = false;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		uint32_t nodeIndex = stack[stackSize];
+		bool isInside = stackInside[stackSize];
+		const BVH_NODE& node = nodes[nodeIndex];
+
+		if (!isInside) {
+			VOLUME_TEST test = TestBox(planes, 5, node.minCoordinates, node.maxCoordinates);
+
+			if (test == VOLUME_OUTSIDE) {
+				continue;
+			}
+
+			isInside = test == VOLUME_INSIDE;
+		}
+
+		if (node.triangleCount > 0) {
+			visibleFaces.insert(visibleFaces.end(), faces.begin() + node.offset, faces.begin() + node.offset + node.triangleCount);
+			continue;
+		}
+
+		stack[stackSize] = node.offset;
+		stackInside[stackSize++] = isInside;
+		stack[stackSize] = nodeIndex + 1;
+		stackInside[stackSize++] = isInside;
+	}
+
+	return VOLUME_PARTIAL;
+}
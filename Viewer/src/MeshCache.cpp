@@ -0,0 +1,156 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "Constants.h"
+#include <cstring>
+#include <fstream>
+#include <Windows.h>
+
+#define MESH_CACHE_MAGIC					"MSHC"
+#define MESH_CACHE_VERSION					4
+#define MESH_CACHE_EXTENSION				".meshcache"
+#define ALIGN4(size)						(((size) + 3) & ~(size_t) 3)
+
+bool MeshCache::FillHeader(const std::string& sourcePath, MESH_CACHE_HEADER& header)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if (!GetFileAttributesExA(sourcePath.c_str(), GetFileExInfoStandard, &attributes)) {
+		return false;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MESH_CACHE_VERSION;
+	header.sourceSize = ((uint64_t) attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	header.sourceModifiedTime = ((uint64_t) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	header.sourcePathLength = (uint32_t) sourcePath.size();
+
+	return true;
+}
+
+std::string MeshCache::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + MESH_CACHE_EXTENSION;
+}
+
+std::shared_ptr<MeshGeometry> MeshCache::Load(const std::string& sourcePath)
+{
+	MESH_CACHE_HEADER expected;
+	MappedFile file;
+
+	// The stored source path follows the header, a truncated file must not be compared past its end
+	if (!FillHeader(sourcePath, expected) || file.Open(GetCachePath(sourcePath)) != SUCCESS ||
+		file.GetSize() < sizeof(MESH_CACHE_HEADER) + ALIGN4(sourcePath.size())) {
+		return nullptr;
+	}
+
+	// Any mismatch means the cache belongs to another version of the source (or of this format)
+	const MESH_CACHE_HEADER* header = (const MESH_CACHE_HEADER*) file.GetData();
+
+	if (memcmp(header->magic, expected.magic, sizeof(header->magic)) != 0 ||
+		header->version != expected.version ||
+		header->sourceSize != expected.sourceSize ||
+		header->sourceModifiedTime != expected.sourceModifiedTime ||
+		header->sourcePathLength != expected.sourcePathLength ||
+		memcmp(file.GetData() + sizeof(MESH_CACHE_HEADER), sourcePath.c_str(), sourcePath.size()) != 0)
+	{
+		return nullptr;
+	}
+
+	size_t vertexCount = (size_t) header->vertexCount;
+	size_t normalCount = (size_t) header->normalCount;
+	size_t textureVertexCount = (size_t) header->textureVertexCount;
+	size_t indexCount = (size_t) header->faceCount * FACE_ELEMENTS;
+
+	if ((normalCount != 0 && normalCount != vertexCount) || (textureVertexCount != 0 && textureVertexCount != vertexCount)) {
+		return nullptr;
+	}
+
+	size_t expectedSize = sizeof(MESH_CACHE_HEADER) + ALIGN4(sourcePath.size()) +
+		(vertexCount + normalCount) * sizeof(glm::vec3) +
+		textureVertexCount * sizeof(glm::vec2) +
+		indexCount * sizeof(uint32_t);
+
+	if (file.GetSize() != expectedSize) {
+		return nullptr;
+	}
+
+	const char* cursor = file.GetData() + sizeof(MESH_CACHE_HEADER) + ALIGN4(sourcePath.size());
+	std::shared_ptr<MeshGeometry> geometry(new MeshGeometry());
+
+	const glm::vec3* vertexBuffer = (const glm::vec3*) cursor;
+	geometry->vertexBuffer.assign(vertexBuffer, vertexBuffer + vertexCount);
+	cursor += vertexCount * sizeof(glm::vec3);
+
+	const glm::vec3* normalBuffer = (const glm::vec3*) cursor;
+	geometry->normalBuffer.assign(normalBuffer, normalBuffer + normalCount);
+	cursor += normalCount * sizeof(glm::vec3);
+
+	const glm::vec2* textureBuffer = (const glm::vec2*) cursor;
+	geometry->textureBuffer.assign(textureBuffer, textureBuffer + textureVertexCount);
+	cursor += textureVertexCount * sizeof(glm::vec2);
+
+	const uint32_t* indexBuffer = (const uint32_t*) cursor;
+	geometry->indexBuffer.assign(indexBuffer, indexBuffer + indexCount);
+
+	// A corrupted index must not make the renderer read past the vertex buffer
+	for each (uint32_t index in geometry->indexBuffer) {
+		if (index >= vertexCount) {
+			return nullptr;
+		}
+	}
+
+	geometry->centroid = glm::vec3(header->centroid[0], header->centroid[1], header->centroid[2]);
+	geometry->minCoordinates = glm::vec3(header->minCoordinates[0], header->minCoordinates[1], header->minCoordinates[2]);
+	geometry->maxCoordinates = glm::vec3(header->maxCoordinates[0], header->maxCoordinates[1], header->maxCoordinates[2]);
+	geometry->buildEdgeBuffer();
+	geometry->buildBorderCube();
+
+	return geometry;
+}
+
+RETURN_VALUE MeshCache::Store(const std::string& sourcePath, const MeshGeometry& geometry)
+{
+	MESH_CACHE_HEADER header;
+
+	if (!FillHeader(sourcePath, header)) {
+		return IO_ERROR;
+	}
+
+	header.vertexCount = geometry.vertexBuffer.size();
+	header.normalCount = geometry.normalBuffer.size();
+	header.textureVertexCount = geometry.textureBuffer.size();
+	header.faceCount = geometry.indexBuffer.size() / FACE_ELEMENTS;
+
+	for (int i = 0; i < 3; i++) {
+		header.centroid[i] = geometry.centroid[i];
+		header.minCoordinates[i] = geometry.minCoordinates[i];
+		header.maxCoordinates[i] = geometry.maxCoordinates[i];
+	}
+
+	// Write next to the final file and rename it, so a reader never maps a half written cache
+	std::string cachePath = GetCachePath(sourcePath);
+	std::string temporaryPath = cachePath + ".tmp";
+	std::ofstream output(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (output.fail()) {
+		return IO_ERROR;
+	}
+
+	const char padding[4] = { 0, 0, 0, 0 };
+	output.write((const char*) &header, sizeof(header));
+	output.write(sourcePath.c_str(), sourcePath.size());
+	output.write(padding, ALIGN4(sourcePath.size()) - sourcePath.size());
+	output.write((const char*) geometry.vertexBuffer.data(), geometry.vertexBuffer.size() * sizeof(glm::vec3));
+	output.write((const char*) geometry.normalBuffer.data(), geometry.normalBuffer.size() * sizeof(glm::vec3));
+	output.write((const char*) geometry.textureBuffer.data(), geometry.textureBuffer.size() * sizeof(glm::vec2));
+	output.write((const char*) geometry.indexBuffer.data(), geometry.indexBuffer.size() * sizeof(uint32_t));
+	output.close();
+
+	if (output.fail() || !MoveFileExA(temporaryPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileA(temporaryPath.c_str());
+		return IO_ERROR;
+	}
+
+	return SUCCESS;
+}
@@ -0,0 +1,512 @@
+#include "MeshGeometry.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdio.h>
+#include "WorkerPool.h"
+
+// Vertices are reduced in fixed blocks, so the result does not depend on how many threads took part
+#define BOUNDS_BLOCK_VERTICES				65536
+// 8 vertices of 3 floats, lane i always holds axis i % 3
+#define BOUNDS_LANES						24
+// Largest difference to the serial reference, relative to the extent of the model. The centroid sums round
+// differently in another order, min and max have to match exactly.
+#define BOUNDS_REFERENCE_TOLERANCE			1e-5f
+
+typedef struct _BOUNDS_BLOCK_
+{
+	glm::vec3 minCoordinates;
+	glm::vec3 maxCoordinates;
+	double sum[3];
+
+} BOUNDS_BLOCK, *PBOUNDS_BLOCK;
+
+// Runs task(0) .. task(taskCount - 1) on all cores, every task writes only its own results. The pool runs one job
+// at a time, a geometry built while another one is using it is reduced on the calling thread instead.
+static void RunParallel(size_t taskCount, const std::function<void(size_t)>& task)
+{
+	static WorkerPool boundsPool;
+	static std::mutex boundsPoolMutex;
+	std::unique_lock<std::mutex> lock(boundsPoolMutex, std::try_to_lock);
+
+	if (!lock.owns_lock()) {
+		for (size_t i = 0; i < taskCount; i++) {
+			task(i);
+		}
+
+		return;
+	}
+
+	boundsPool.Run(taskCount, task);
+}
+
+static void ReduceBoundsBlock(const glm::vec3* vertices, size_t count, BOUNDS_BLOCK& block)
+{
+	// The vertices are read as a flat float array, one accumulator per lane lets the compiler keep them in SIMD registers
+	const float* values = &vertices[0].x;
+	size_t valueCount = count * 3;
+	size_t fullCount = valueCount / BOUNDS_LANES * BOUNDS_LANES;
+	float laneMin[BOUNDS_LANES];
+	float laneMax[BOUNDS_LANES];
+	double laneSum[BOUNDS_LANES];
+
+	for (int lane = 0; lane < BOUNDS_LANES; lane++) {
+		laneMin[lane] = std::numeric_limits<float>::max();
+		laneMax[lane] = -std::numeric_limits<float>::max();
+		laneSum[lane] = 0;
+	}
+
+	for (size_t i = 0; i < fullCount; i += BOUNDS_LANES) {
+		for (int lane = 0; lane < BOUNDS_LANES; lane++) {
+			float value = values[i + lane];
+			laneMin[lane] = value < laneMin[lane] ? value : laneMin[lane];
+			laneMax[lane] = value > laneMax[lane] ? value : laneMax[lane];
+			laneSum[lane] += value;
+		}
+	}
+
+	for (size_t i = fullCount; i < valueCount; i++) {
+		size_t lane = i - fullCount;
+		laneMin[lane] = values[i] < laneMin[lane] ? values[i] : laneMin[lane];
+		laneMax[lane] = values[i] > laneMax[lane] ? values[i] : laneMax[lane];
+		laneSum[lane] += values[i];
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		block.minCoordinates[axis] = laneMin[axis];
+		block.maxCoordinates[axis] = laneMax[axis];
+		block.sum[axis] = 0;
+
+		for (int lane = axis; lane < BOUNDS_LANES; lane += 3) {
+			block.minCoordinates[axis] = fmin(block.minCoordinates[axis], laneMin[lane]);
+			block.maxCoordinates[axis] = fmax(block.maxCoordinates[axis], laneMax[lane]);
+			block.sum[axis] += laneSum[lane];
+		}
+	}
+}
+
+glm::vec3 MeshGeometry::NormalizeVertex(const glm::vec3& vertex, const glm::vec3& centroid, float absoluteMin, float absoluteMax)
+{
+	glm::vec3 normalizedVector;
+
+	normalizedVector.x = NORMALIZE_COORDS((vertex.x - centroid.x), absoluteMin, absoluteMax);
+	normalizedVector.y = NORMALIZE_COORDS((vertex.y - centroid.y), absoluteMin, absoluteMax);
+	normalizedVector.z = NORMALIZE_COORDS((vertex.z - centroid.z), absoluteMin, absoluteMax);
+
+	return normalizedVector;
+}
+
+MeshGeometry::MeshGeometry() :
+	centroid({ 0, 0, 0 }),
+	minCoordinates({ 0, 0, 0 }),
+	maxCoordinates({ 0, 0, 0 })
+{
+
+}
+
+MeshGeometry::MeshGeometry(MESH_DATA&& meshData)
+{
+	ComputeBounds(meshData.vertices, centroid, minCoordinates, maxCoordinates);
+
+	// Create triangles as a single index buffer over the welded vertices, normalizing every vertex as it is welded
+	float absoluteMin = fmin(fmin(minCoordinates.x - centroid.x, minCoordinates.y - centroid.y), minCoordinates.z - centroid.z);
+	float absoluteMax = fmax(fmax(maxCoordinates.x - centroid.x, maxCoordinates.y - centroid.y), maxCoordinates.z - centroid.z);
+	buildVertexBuffers(meshData, centroid, absoluteMin, absoluteMax);
+	NormalizeBounds(centroid, minCoordinates, maxCoordinates);
+
+#ifdef _DEBUG
+	if (!MatchesReference(meshData)) {
+		fprintf(stderr, "The parallel bounds differ from the serial reference\n");
+	}
+#endif
+
+	// The parsed arrays are not needed anymore, the welded buffers are all that is drawn
+	meshData = MESH_DATA();
+
+	buildEdgeBuffer();
+	buildBorderCube();
+}
+
+MeshGeometry::MeshGeometry(const glm::vec3& centroid_, const glm::vec3& minCoordinates_, const glm::vec3& maxCoordinates_) :
+	centroid(centroid_),
+	minCoordinates(minCoordinates_),
+	maxCoordinates(maxCoordinates_)
+{
+	buildBorderCube();
+}
+
+MESH_VIEW MeshGeometry::GetView() const
+{
+	MESH_VIEW view;
+
+	view.vertices = vertexBuffer;
+	view.normals = normalBuffer;
+	view.indices = indexBuffer;
+	view.edges = edgeBuffer;
+	view.edgeVertices = edgeVertexBuffer;
+
+	return view;
+}
+
+const VERTEX_STREAMS& MeshGeometry::GetPositionStreams() const
+{
+	std::call_once(streamsBuilt, [this]() {
+		VertexStreams::Build(vertexBuffer, positionStreams);
+		VertexStreams::Build(normalBuffer, normalStreams);
+	});
+
+	return positionStreams;
+}
+
+const VERTEX_STREAMS& MeshGeometry::GetNormalStreams() const
+{
+	GetPositionStreams();
+
+	return normalStreams;
+}
+
+const MeshBvh& MeshGeometry::GetBvh() const
+{
+	std::call_once(bvhBuilt, [this]() {
+		bvh.Build(vertexBuffer, indexBuffer);
+	});
+
+	return bvh;
+}
+
+MESH_MEMORY MeshGeometry::GetMemoryUsage() const
+{
+	MESH_MEMORY memory;
+
+	memory.vertexBytes = vertexBuffer.capacity() * sizeof(glm::vec3);
+	memory.normalBytes = normalBuffer.capacity() * sizeof(glm::vec3);
+	memory.textureBytes = textureBuffer.capacity() * sizeof(glm::vec2);
+	memory.indexBytes = indexBuffer.capacity() * sizeof(uint32_t);
+	memory.edgeBytes = (edgeBuffer.capacity() + edgeVertexBuffer.capacity()) * sizeof(uint32_t);
+	memory.streamBytes = VertexStreams::GetBytes(positionStreams) + VertexStreams::GetBytes(normalStreams);
+	memory.bvhBytes = bvh.GetBytes();
+	memory.totalBytes = sizeof(MeshGeometry) + memory.vertexBytes + memory.normalBytes + memory.textureBytes + memory.indexBytes + memory.edgeBytes + memory.streamBytes + memory.bvhBytes;
+
+	return memory;
+}
+
+void MeshGeometry::ComputeBounds(const std::vector<glm::vec3>& vertices, glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates)
+{
+	centroid = { 0, 0, 0 };
+	minCoordinates = { 0, 0, 0 };
+	maxCoordinates = { 0, 0, 0 };
+
+	if (vertices.empty()) {
+		return;
+	}
+
+	size_t blockCount = (vertices.size() + BOUNDS_BLOCK_VERTICES - 1) / BOUNDS_BLOCK_VERTICES;
+	std::vector<BOUNDS_BLOCK> blocks(blockCount);
+
+	RunParallel(blockCount, [&vertices, &blocks](size_t block) {
+		size_t begin = block * BOUNDS_BLOCK_VERTICES;
+		size_t end = begin + BOUNDS_BLOCK_VERTICES < vertices.size() ? begin + BOUNDS_BLOCK_VERTICES : vertices.size();
+		ReduceBoundsBlock(&vertices[begin], end - begin, blocks[block]);
+	});
+
+	// Blocks are combined in order, so the sums round the same way on any machine
+	double sum[3] = { 0, 0, 0 };
+	minCoordinates = blocks[0].minCoordinates;
+	maxCoordinates = blocks[0].maxCoordinates;
+
+	for each (const BOUNDS_BLOCK& block in blocks) {
+		for (int axis = 0; axis < 3; axis++) {
+			minCoordinates[axis] = fmin(minCoordinates[axis], block.minCoordinates[axis]);
+			maxCoordinates[axis] = fmax(maxCoordinates[axis], block.maxCoordinates[axis]);
+			sum[axis] += block.sum[axis];
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		centroid[axis] = (float) (sum[axis] / vertices.size());
+	}
+}
+
+void MeshGeometry::ComputeBoundsReference(const std::vector<glm::vec3>& vertices, glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates)
+{
+	centroid = { 0, 0, 0 };
+	minCoordinates = { 0, 0, 0 };
+	maxCoordinates = { 0, 0, 0 };
+
+	if (vertices.empty()) {
+		return;
+	}
+
+	// A single pass in vertex order, nothing shared with the blocked reduction of ComputeBounds
+	double sum[3] = { 0, 0, 0 };
+	minCoordinates = vertices[0];
+	maxCoordinates = vertices[0];
+
+	for each (const glm::vec3& vertex in vertices) {
+		for (int axis = 0; axis < 3; axis++) {
+			minCoordinates[axis] = vertex[axis] < minCoordinates[axis] ? vertex[axis] : minCoordinates[axis];
+			maxCoordinates[axis] = vertex[axis] > maxCoordinates[axis] ? vertex[axis] : maxCoordinates[axis];
+			sum[axis] += vertex[axis];
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		centroid[axis] = (float) (sum[axis] / vertices.size());
+	}
+}
+
+bool MeshGeometry::MatchesReferenceBounds(const std::vector<glm::vec3>& vertices)
+{
+	glm::vec3 centroid, minCoordinates, maxCoordinates;
+	glm::vec3 referenceCentroid, referenceMin, referenceMax;
+	ComputeBounds(vertices, centroid, minCoordinates, maxCoordinates);
+	ComputeBoundsReference(vertices, referenceCentroid, referenceMin, referenceMax);
+
+	glm::vec3 extent = referenceMax - referenceMin;
+	float tolerance = BOUNDS_REFERENCE_TOLERANCE * fmax(fmax(fmax(extent.x, extent.y), extent.z), 1.0f);
+	glm::vec3 centroidError = glm::abs(centroid - referenceCentroid);
+
+	return minCoordinates == referenceMin && maxCoordinates == referenceMax &&
+		centroidError.x <= tolerance && centroidError.y <= tolerance && centroidError.z <= tolerance;
+}
+
+bool MeshGeometry::MatchesReference(const MESH_DATA& meshData) const
+{
+	glm::vec3 rawCentroid, referenceCentroid, referenceMin, referenceMax;
+	ComputeBoundsReference(meshData.vertices, rawCentroid, referenceMin, referenceMax);
+
+	float absoluteMin = fmin(fmin(referenceMin.x - rawCentroid.x, referenceMin.y - rawCentroid.y), referenceMin.z - rawCentroid.z);
+	float absoluteMax = fmax(fmax(referenceMax.x - rawCentroid.x, referenceMax.y - rawCentroid.y), referenceMax.z - rawCentroid.z);
+	referenceCentroid = rawCentroid;
+	NormalizeBounds(referenceCentroid, referenceMin, referenceMax);
+
+	// Everything compared here is normalized into [-1, 1], so the tolerance is absolute
+	auto isNear = [](const glm::vec3& value, const glm::vec3& reference) {
+		glm::vec3 error = glm::abs(value - reference);
+		return error.x <= BOUNDS_REFERENCE_TOLERANCE && error.y <= BOUNDS_REFERENCE_TOLERANCE && error.z <= BOUNDS_REFERENCE_TOLERANCE;
+	};
+
+	if (!isNear(centroid, referenceCentroid) || !isNear(minCoordinates, referenceMin) || !isNear(maxCoordinates, referenceMax) ||
+		indexBuffer.size() != meshData.vertexIndices.size()) {
+		return false;
+	}
+
+	// Every corner has to reach the normalized position of its parsed vertex through the index buffer
+	for (size_t i = 0; i < indexBuffer.size(); i++) {
+		if (!isNear(vertexBuffer[indexBuffer[i]], NormalizeVertex(meshData.vertices[meshData.vertexIndices[i]], rawCentroid, absoluteMin, absoluteMax))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void MeshGeometry::NormalizeBounds(glm::vec3& centroid, glm::vec3& minCoordinates, glm::vec3& maxCoordinates)
+{
+	minCoordinates -= centroid;
+	maxCoordinates -= centroid;
+
+	// Find absolute minimum and maximum
+	float absoluteMin = fmin(fmin(minCoordinates.x, minCoordinates.y), minCoordinates.z);
+	float absoluteMax = fmax(fmax(maxCoordinates.x, maxCoordinates.y), maxCoordinates.z);
+
+	// Calculate normalized centroid coordinates
+	centroid.x = NORMALIZE_COORDS(0, absoluteMin, absoluteMax);
+	centroid.y = NORMALIZE_COORDS(0, absoluteMin, absoluteMax);
+	centroid.z = NORMALIZE_COORDS(0, absoluteMin, absoluteMax);
+	// Calculate normalized minimum coordinates
+	minCoordinates.x = NORMALIZE_COORDS(minCoordinates.x, absoluteMin, absoluteMax);
+	minCoordinates.y = NORMALIZE_COORDS(minCoordinates.y, absoluteMin, absoluteMax);
+	minCoordinates.z = NORMALIZE_COORDS(minCoordinates.z, absoluteMin, absoluteMax);
+	// Calculate normalized maximum coordiantes
+	maxCoordinates.x = NORMALIZE_COORDS(maxCoordinates.x, absoluteMin, absoluteMax);
+	maxCoordinates.y = NORMALIZE_COORDS(maxCoordinates.y, absoluteMin, absoluteMax);
+	maxCoordinates.z = NORMALIZE_COORDS(maxCoordinates.z, absoluteMin, absoluteMax);
+}
+
+void MeshGeometry::buildVertexBuffers(const MESH_DATA& meshData, const glm::vec3& rawCentroid, float absoluteMin, float absoluteMax)
+{
+	const uint32_t NO_VERTEX = 0xFFFFFFFF;
+	const std::vector<int>& vertexIndices = meshData.vertexIndices;
+	const std::vector<int>& normalIndices = meshData.normalIndices;
+	const std::vector<int>& textureIndices = meshData.textureIndices;
+	const bool hasNormals = !normalIndices.empty();
+	const bool hasTextures = !textureIndices.empty();
+
+	// Welded vertices are chained per position index, so a lookup only compares the tuples sharing that position
+	std::vector<uint32_t> firstWelded(meshData.vertices.size(), NO_VERTEX);
+	std::vector<uint32_t> nextWelded;
+	std::vector<int> weldedNormalIndices;
+	std::vector<int> weldedTextureIndices;
+
+	// Most positions weld into exactly one vertex, so this is usually the final size
+	vertexBuffer.clear();
+	vertexBuffer.reserve(meshData.vertices.size());
+	normalBuffer.clear();
+	normalBuffer.reserve(hasNormals ? meshData.vertices.size() : 0);
+	textureBuffer.clear();
+	textureBuffer.reserve(hasTextures ? meshData.vertices.size() : 0);
+	nextWelded.reserve(meshData.vertices.size());
+	weldedNormalIndices.reserve(meshData.vertices.size());
+	weldedTextureIndices.reserve(meshData.vertices.size());
+	indexBuffer.resize(vertexIndices.size());
+
+	for (size_t i = 0; i < vertexIndices.size(); i++) {
+		int vertexIndex = vertexIndices[i];
+		int normalIndex = hasNormals ? normalIndices[i] : -1;
+		int textureIndex = hasTextures ? textureIndices[i] : -1;
+		uint32_t welded = firstWelded[vertexIndex];
+
+		while (welded != NO_VERTEX && (weldedNormalIndices[welded] != normalIndex || weldedTextureIndices[welded] != textureIndex)) {
+			welded = nextWelded[welded];
+		}
+
+		if (welded == NO_VERTEX) {
+			welded = (uint32_t) vertexBuffer.size();
+			vertexBuffer.push_back(NormalizeVertex(meshData.vertices[vertexIndex], rawCentroid, absoluteMin, absoluteMax));
+
+			if (hasNormals) {
+				normalBuffer.push_back(normalIndex >= 0 ? meshData.normals[normalIndex] : glm::vec3(0, 0, 0));
+			}
+
+			if (hasTextures) {
+				textureBuffer.push_back(textureIndex >= 0 ? meshData.textureVertices[textureIndex] : glm::vec2(0, 0));
+			}
+
+			weldedNormalIndices.push_back(normalIndex);
+			weldedTextureIndices.push_back(textureIndex);
+			nextWelded.push_back(firstWelded[vertexIndex]);
+			firstWelded[vertexIndex] = welded;
+		}
+
+		indexBuffer[i] = welded;
+	}
+
+	// Drop the spare capacity left when positions were unused or welded into several vertices
+	vertexBuffer.shrink_to_fit();
+	normalBuffer.shrink_to_fit();
+	textureBuffer.shrink_to_fit();
+}
+
+void MeshGeometry::GroupPositions(const std::vector<glm::vec3>& vertices, std::vector<uint32_t>& positionOf, std::vector<uint32_t>& representatives)
+{
+	std::vector<uint32_t> order(vertices.size());
+
+	for (uint32_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+
+	// Ties are ordered by index, so every group starts with its lowest welded vertex
+	std::sort(order.begin(), order.end(), [&vertices](uint32_t left, uint32_t right) {
+		const glm::vec3& a = vertices[left];
+		const glm::vec3& b = vertices[right];
+		return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : (a.z != b.z ? a.z < b.z : left < right));
+	});
+
+	positionOf.resize(vertices.size());
+	representatives.clear();
+
+	for (size_t i = 0; i < order.size(); i++) {
+		if (i == 0 || vertices[order[i]] != vertices[order[i - 1]]) {
+			representatives.push_back(order[i]);
+		}
+
+		positionOf[order[i]] = (uint32_t) representatives.size() - 1;
+	}
+}
+
+void MeshGeometry::BuildEdges(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, std::vector<uint32_t>& edges, std::vector<uint32_t>* edgeVertices /*= NULL*/)
+{
+	// Welded vertices split only by a normal or texture seam share their edges, so edges are found over positions
+	std::vector<uint32_t> positionOf;
+	std::vector<uint32_t> representatives;
+	GroupPositions(vertices, positionOf, representatives);
+
+	// Bucket every face edge by its lower position, then drop the repeats inside each (small) bucket
+	size_t cornerCount = indices.size() / FACE_ELEMENTS * FACE_ELEMENTS;
+	size_t positionCount = representatives.size();
+	std::vector<uint32_t> firstEdge(positionCount + 1, 0);
+	std::vector<uint32_t> upperPositions(cornerCount);
+
+	for (size_t i = 0; i < cornerCount; i++) {
+		uint32_t first = positionOf[indices[i]];
+		uint32_t second = positionOf[indices[i - i % FACE_ELEMENTS + (i + 1) % FACE_ELEMENTS]];
+		firstEdge[(first < second ? first : second) + 1]++;
+	}
+
+	for (size_t position = 0; position < positionCount; position++) {
+		firstEdge[position + 1] += firstEdge[position];
+	}
+
+	std::vector<uint32_t> cursor(firstEdge.begin(), firstEdge.end() - 1);
+
+	for (size_t i = 0; i < cornerCount; i++) {
+		uint32_t first = positionOf[indices[i]];
+		uint32_t second = positionOf[indices[i - i % FACE_ELEMENTS + (i + 1) % FACE_ELEMENTS]];
+		upperPositions[cursor[first < second ? first : second]++] = first < second ? second : first;
+	}
+
+	edges.clear();
+	edges.reserve(cornerCount);
+
+	for (uint32_t position = 0; position < positionCount; position++) {
+		uint32_t* begin = upperPositions.data() + firstEdge[position];
+		uint32_t* end = upperPositions.data() + firstEdge[position + 1];
+
+		std::sort(begin, end);
+		end = std::unique(begin, end);
+
+		for (uint32_t* upper = begin; upper != end; upper++) {
+			// Degenerate faces have edges from a position to itself, there is nothing to draw
+			if (*upper != position) {
+				edges.push_back(representatives[position]);
+				edges.push_back(representatives[*upper]);
+			}
+		}
+	}
+
+	edges.shrink_to_fit();
+
+	if (edgeVertices != NULL) {
+		edgeVertices->resize(vertices.size());
+
+		for (size_t i = 0; i < vertices.size(); i++) {
+			(*edgeVertices)[i] = representatives[positionOf[i]];
+		}
+	}
+}
+
+void MeshGeometry::buildEdgeBuffer()
+{
+	BuildEdges(vertexBuffer, indexBuffer, edgeBuffer, &edgeVertexBuffer);
+}
+
+void MeshGeometry::buildBorderCube()
+{
+	INIT_CUBE_COORDINATES(maxCoordinates, minCoordinates);
+
+	glm::vec3      RNB = { cRight , cBottom , cNear };	//            _________________________RFT=maxCoordinates(x,y,z)
+	glm::vec3      RFB = { cRight , cBottom , cFar };	//           /LFT___________________  /|
+	glm::vec3      LFB = { cLeft  , cBottom , cFar };	//          / / ___________________/ / |
+	glm::vec3      LNB = { cLeft  , cBottom , cNear };  //         / / /| |               / /  |
+	glm::vec3      RNT = { cRight , cTop    , cNear };	//        / / / | |              / / . |
+	glm::vec3      RFT = { cRight , cTop    , cFar };	//       / / /| | |             / / /| |
+	glm::vec3      LFT = { cLeft  , cTop    , cFar };	//      / / / | | |            / / / | |
+	glm::vec3      LNT = { cLeft  , cTop    , cNear };  //     / / /  | | |           / / /| | |
+														//    / /_/__________________/ / / | | |
+	cubeLines.line[0] = { RNB, RFB };					//   /LNT___________________ _/ /  | | |
+	cubeLines.line[1] = { RNB, LNB };					//   | ____________________RNT| |  | | |
+	cubeLines.line[2] = { RNB, RNT };					//   | | |    | | |_________| | |__| | |
+	cubeLines.line[3] = { RFB, LFB };					//   | | |    | |___________| | |____| |
+	cubeLines.line[4] = { RFB, RFT };					//   | | |   / /LFB_________| | |_  / /RFB
+	cubeLines.line[5] = { LFB, LNB };					//   | | |  / / /           | | |/ / /
+	cubeLines.line[6] = { LFB, LFT };					//   | | | / / /            | | | / /
+	cubeLines.line[7] = { LNB, LNT };					//   | | |/ / /             | | |/ /
+	cubeLines.line[8] = { RNT, LNT };					//   | | | / /              | | ' /
+	cubeLines.line[9] = { RNT, RFT };					//   | | |/_/_______________| |  /
+	cubeLines.line[10] = { RFT, LFT };					//   | |____________________| | /
+	cubeLines.line[11] = { LFT, LNT };					//   |________________________|/
+														//   LNB=minCoordinates(u,v,w)   RNB   
+}
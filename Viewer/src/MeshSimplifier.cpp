@@ -0,0 +1,368 @@
+#include "MeshSimplifier.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+// How strongly border edges resist moving, relative to the faces around them
+#define BORDER_PLANE_WEIGHT					1000.0
+#define NO_VERTEX							0xFFFFFFFF
+#define CANCEL_CHECK_INTERVAL				4096
+
+typedef struct _SIMPLIFIER_EDGE_
+{
+	uint32_t first;
+	uint32_t second;
+	uint32_t face;
+
+	bool operator<(const _SIMPLIFIER_EDGE_& other) const
+	{
+		return first != other.first ? first < other.first : second < other.second;
+	}
+
+} SIMPLIFIER_EDGE, *PSIMPLIFIER_EDGE;
+
+void MeshSimplifier::AddPlane(QUADRIC& quadric, double a, double b, double c, double d, double weight)
+{
+	quadric.a2 += weight * a * a;
+	quadric.ab += weight * a * b;
+	quadric.ac += weight * a * c;
+	quadric.ad += weight * a * d;
+	quadric.b2 += weight * b * b;
+	quadric.bc += weight * b * c;
+	quadric.bd += weight * b * d;
+	quadric.c2 += weight * c * c;
+	quadric.cd += weight * c * d;
+	quadric.d2 += weight * d * d;
+}
+
+void MeshSimplifier::AddQuadric(QUADRIC& quadric, const QUADRIC& other)
+{
+	quadric.a2 += other.a2;
+	quadric.ab += other.ab;
+	quadric.ac += other.ac;
+	quadric.ad += other.ad;
+	quadric.b2 += other.b2;
+	quadric.bc += other.bc;
+	quadric.bd += other.bd;
+	quadric.c2 += other.c2;
+	quadric.cd += other.cd;
+	quadric.d2 += other.d2;
+}
+
+double MeshSimplifier::GetError(const QUADRIC& quadric, const glm::vec3& position)
+{
+	double x = position.x;
+	double y = position.y;
+	double z = position.z;
+
+	return quadric.a2 * x * x + 2 * quadric.ab * x * y + 2 * quadric.ac * x * z + 2 * quadric.ad * x +
+		quadric.b2 * y * y + 2 * quadric.bc * y * z + 2 * quadric.bd * y +
+		quadric.c2 * z * z + 2 * quadric.cd * z +
+		quadric.d2;
+}
+
+EDGE_COLLAPSE MeshSimplifier::GetCollapse(const std::vector<QUADRIC>& quadrics, const std::vector<glm::vec3>& positions, uint32_t keptVertex, uint32_t removedVertex)
+{
+	QUADRIC quadric = quadrics[keptVertex];
+	AddQuadric(quadric, quadrics[removedVertex]);
+
+	const glm::vec3& first = positions[keptVertex];
+	const glm::vec3& second = positions[removedVertex];
+	glm::vec3 middle = (first + second) * 0.5f;
+
+	glm::vec3 candidates[4] = { first, second, middle };
+	int candidateCount = 3;
+
+	// The position minimizing the error solves the 3x3 system of the quadric. On flat or straight surfaces the
+	// system is (nearly) singular and the solution may land far away, so it is only used close to the edge.
+	double determinant =
+		quadric.a2 * (quadric.b2 * quadric.c2 - quadric.bc * quadric.bc) -
+		quadric.ab * (quadric.ab * quadric.c2 - quadric.bc * quadric.ac) +
+		quadric.ac * (quadric.ab * quadric.bc - quadric.b2 * quadric.ac);
+
+	if (determinant != 0) {
+		double x = (-quadric.ad * (quadric.b2 * quadric.c2 - quadric.bc * quadric.bc) -
+			quadric.ab * (-quadric.bd * quadric.c2 + quadric.bc * quadric.cd) +
+			quadric.ac * (-quadric.bd * quadric.bc + quadric.b2 * quadric.cd)) / determinant;
+		double y = (quadric.a2 * (-quadric.bd * quadric.c2 + quadric.bc * quadric.cd) -
+			(-quadric.ad) * (quadric.ab * quadric.c2 - quadric.bc * quadric.ac) +
+			quadric.ac * (-quadric.ab * quadric.cd + quadric.bd * quadric.ac)) / determinant;
+		double z = (quadric.a2 * (-quadric.b2 * quadric.cd + quadric.bd * quadric.bc) -
+			quadric.ab * (-quadric.ab * quadric.cd + quadric.bd * quadric.ac) +
+			(-quadric.ad) * (quadric.ab * quadric.bc - quadric.b2 * quadric.ac)) / determinant;
+		glm::vec3 optimum((float) x, (float) y, (float) z);
+
+		if (glm::length(optimum - middle) <= glm::length(second - first)) {
+			candidates[candidateCount++] = optimum;
+		}
+	}
+
+	EDGE_COLLAPSE collapse;
+	collapse.keptVertex = keptVertex;
+	collapse.removedVertex = removedVertex;
+	collapse.cost = GetError(quadric, candidates[0]);
+	collapse.position = candidates[0];
+
+	for (int i = 1; i < candidateCount; i++) {
+		double cost = GetError(quadric, candidates[i]);
+
+		if (cost < collapse.cost) {
+			collapse.cost = cost;
+			collapse.position = candidates[i];
+		}
+	}
+
+	return collapse;
+}
+
+std::shared_ptr<const MeshGeometry> MeshSimplifier::Simplify(const MeshGeometry& source, size_t targetFaceCount, const std::atomic<bool>* cancelled)
+{
+	const std::vector<glm::vec3>& sourceVertices = source.GetVertexBuffer();
+	const std::vector<uint32_t>& sourceIndices = source.GetIndexBuffer();
+
+	// Merge welded vertices sharing a position, they were only split for their normals or texture coordinates
+	std::vector<uint32_t> positionOf;
+	std::vector<uint32_t> representatives;
+	MeshGeometry::GroupPositions(sourceVertices, positionOf, representatives);
+
+	std::vector<glm::vec3> positions(representatives.size());
+
+	for (size_t i = 0; i < representatives.size(); i++) {
+		positions[i] = sourceVertices[representatives[i]];
+	}
+
+	// Faces over the merged positions, faces which became degenerate by the merge are dropped
+	std::vector<uint32_t> faces;
+	faces.reserve(sourceIndices.size());
+
+	for (size_t i = 0; i + FACE_ELEMENTS <= sourceIndices.size(); i += FACE_ELEMENTS) {
+		uint32_t a = positionOf[sourceIndices[i]];
+		uint32_t b = positionOf[sourceIndices[i + 1]];
+		uint32_t c = positionOf[sourceIndices[i + 2]];
+
+		if (a != b && b != c && c != a) {
+			faces.push_back(a);
+			faces.push_back(b);
+			faces.push_back(c);
+		}
+	}
+
+	size_t faceCount = faces.size() / FACE_ELEMENTS;
+	size_t liveFaces = faceCount;
+	std::vector<uint8_t> faceAlive(faceCount, 1);
+	std::vector<uint8_t> vertexAlive(positions.size(), 1);
+	std::vector<uint32_t> stamps(positions.size(), 0);
+	std::vector<std::vector<uint32_t>> vertexFaces(positions.size());
+	std::vector<QUADRIC> quadrics(positions.size(), QUADRIC());
+	std::vector<SIMPLIFIER_EDGE> edges;
+	edges.reserve(faces.size());
+
+	// Every vertex starts with the planes of its faces, weighted by their area
+	for (uint32_t face = 0; face < faceCount; face++) {
+		const glm::vec3& p0 = positions[faces[face * 3]];
+		const glm::vec3& p1 = positions[faces[face * 3 + 1]];
+		const glm::vec3& p2 = positions[faces[face * 3 + 2]];
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double area = glm::length(normal);
+
+		for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+			uint32_t vertex = faces[face * 3 + corner];
+			uint32_t next = faces[face * 3 + (corner + 1) % FACE_ELEMENTS];
+			SIMPLIFIER_EDGE edge = { vertex < next ? vertex : next, vertex < next ? next : vertex, face };
+
+			vertexFaces[vertex].push_back(face);
+			edges.push_back(edge);
+
+			if (area > 0) {
+				AddPlane(quadrics[vertex], normal.x / area, normal.y / area, normal.z / area, -glm::dot(normal, p0) / area, area / 2);
+			}
+		}
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	std::priority_queue<EDGE_COLLAPSE, std::vector<EDGE_COLLAPSE>, std::greater<EDGE_COLLAPSE>> collapses;
+
+	for (size_t i = 0; i < edges.size();) {
+		size_t next = i + 1;
+
+		while (next < edges.size() && edges[next].first == edges[i].first && edges[next].second == edges[i].second) {
+			next++;
+		}
+
+		// A border edge gets a plane through it, perpendicular to its face, so collapses do not pull the border in
+		if (next - i == 1) {
+			uint32_t face = edges[i].face;
+			const glm::vec3& a = positions[edges[i].first];
+			const glm::vec3& b = positions[edges[i].second];
+			glm::vec3 faceNormal = glm::cross(positions[faces[face * 3 + 1]] - positions[faces[face * 3]], positions[faces[face * 3 + 2]] - positions[faces[face * 3]]);
+			glm::vec3 borderNormal = glm::cross(b - a, faceNormal);
+			double length = glm::length(borderNormal);
+
+			if (length > 0) {
+				double weight = BORDER_PLANE_WEIGHT * glm::dot(b - a, b - a);
+				double distance = -glm::dot(borderNormal, a) / length;
+				AddPlane(quadrics[edges[i].first], borderNormal.x / length, borderNormal.y / length, borderNormal.z / length, distance, weight);
+				AddPlane(quadrics[edges[i].second], borderNormal.x / length, borderNormal.y / length, borderNormal.z / length, distance, weight);
+			}
+		}
+
+		i = next;
+	}
+
+	for (size_t i = 0; i < edges.size(); i++) {
+		if (i == 0 || edges[i].first != edges[i - 1].first || edges[i].second != edges[i - 1].second) {
+			EDGE_COLLAPSE collapse = GetCollapse(quadrics, positions, edges[i].first, edges[i].second);
+			collapse.keptStamp = 0;
+			collapse.removedStamp = 0;
+			collapses.push(collapse);
+		}
+	}
+
+	edges.clear();
+	edges.shrink_to_fit();
+
+	// Moving a vertex must not turn any of its remaining faces over
+	auto flipsFace = [&](uint32_t vertex, uint32_t otherVertex, const glm::vec3& position) {
+		for each (uint32_t face in vertexFaces[vertex]) {
+			if (!faceAlive[face]) {
+				continue;
+			}
+
+			uint32_t* corners = &faces[face * 3];
+
+			if (corners[0] == otherVertex || corners[1] == otherVertex || corners[2] == otherVertex) {
+				continue;
+			}
+
+			glm::vec3 before[3] = { positions[corners[0]], positions[corners[1]], positions[corners[2]] };
+			glm::vec3 after[3] = { before[0], before[1], before[2] };
+
+			for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+				if (corners[corner] == vertex) {
+					after[corner] = position;
+				}
+			}
+
+			glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+			glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+			if (glm::dot(normalBefore, normalAfter) <= 0) {
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	std::vector<uint32_t> neighbors;
+	size_t iterations = 0;
+
+	while (liveFaces > targetFaceCount && !collapses.empty()) {
+		if (cancelled && ++iterations % CANCEL_CHECK_INTERVAL == 0 && *cancelled) {
+			return nullptr;
+		}
+
+		EDGE_COLLAPSE collapse = collapses.top();
+		collapses.pop();
+
+		uint32_t kept = collapse.keptVertex;
+		uint32_t removed = collapse.removedVertex;
+
+		// Outdated candidates are left in the queue and skipped here
+		if (!vertexAlive[kept] || !vertexAlive[removed] || stamps[kept] != collapse.keptStamp || stamps[removed] != collapse.removedStamp) {
+			continue;
+		}
+
+		if (flipsFace(kept, removed, collapse.position) || flipsFace(removed, kept, collapse.position)) {
+			continue;
+		}
+
+		positions[kept] = collapse.position;
+		AddQuadric(quadrics[kept], quadrics[removed]);
+		vertexAlive[removed] = 0;
+		stamps[kept]++;
+		stamps[removed]++;
+
+		for each (uint32_t face in vertexFaces[removed]) {
+			if (!faceAlive[face]) {
+				continue;
+			}
+
+			uint32_t* corners = &faces[face * 3];
+
+			if (corners[0] == kept || corners[1] == kept || corners[2] == kept) {
+				faceAlive[face] = 0;
+				liveFaces--;
+				continue;
+			}
+
+			for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+				if (corners[corner] == removed) {
+					corners[corner] = kept;
+				}
+			}
+
+			vertexFaces[kept].push_back(face);
+		}
+
+		std::vector<uint32_t>().swap(vertexFaces[removed]);
+
+		// Drop the faces gone by now and queue the edges around the moved vertex again
+		std::vector<uint32_t>& keptFaces = vertexFaces[kept];
+		keptFaces.erase(std::remove_if(keptFaces.begin(), keptFaces.end(), [&faceAlive](uint32_t face) { return !faceAlive[face]; }), keptFaces.end());
+		neighbors.clear();
+
+		for each (uint32_t face in keptFaces) {
+			for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+				if (faces[face * 3 + corner] != kept) {
+					neighbors.push_back(faces[face * 3 + corner]);
+				}
+			}
+		}
+
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+		for each (uint32_t neighbor in neighbors) {
+			EDGE_COLLAPSE next = GetCollapse(quadrics, positions, kept, neighbor);
+			next.keptStamp = stamps[kept];
+			next.removedStamp = stamps[neighbor];
+			collapses.push(next);
+		}
+	}
+
+	// Compact the remaining faces and the vertices they use
+	std::shared_ptr<MeshGeometry> geometry(new MeshGeometry());
+	std::vector<uint32_t> newIndex(positions.size(), NO_VERTEX);
+
+	geometry->indexBuffer.reserve(liveFaces * FACE_ELEMENTS);
+
+	for (size_t face = 0; face < faceCount; face++) {
+		if (!faceAlive[face]) {
+			continue;
+		}
+
+		for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+			uint32_t vertex = faces[face * 3 + corner];
+
+			if (newIndex[vertex] == NO_VERTEX) {
+				newIndex[vertex] = (uint32_t) geometry->vertexBuffer.size();
+				geometry->vertexBuffer.push_back(positions[vertex]);
+			}
+
+			geometry->indexBuffer.push_back(newIndex[vertex]);
+		}
+	}
+
+	geometry->vertexBuffer.shrink_to_fit();
+	geometry->centroid = source.GetCentroid();
+	geometry->minCoordinates = source.GetMinCoordinates();
+	geometry->maxCoordinates = source.GetMaxCoordinates();
+	geometry->buildEdgeBuffer();
+	geometry->buildBorderCube();
+
+	return geometry;
+}
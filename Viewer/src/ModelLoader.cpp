@@ -0,0 +1,200 @@
+#include "ModelLoader.h"
+#include "Scene.h"
+#include "Utils.h"
+#include <chrono>
+#include <exception>
+#include <stdio.h>
+
+// ModelLoadRequest implementation
+
+ModelLoadRequest::ModelLoadRequest(const std::string& filePath_, bool isPaged_) :
+	filePath(filePath_),
+	isPaged(isPaged_)
+{
+	progress.fraction = 0;
+	progress.cancelled = false;
+	result = promise.get_future();
+}
+
+bool ModelLoadRequest::IsDone() const
+{
+	return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// ModelLoader implementation
+
+ModelLoader::ModelLoader() : stopping(false)
+{
+
+}
+
+ModelLoader::~ModelLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+
+		for (auto& request : queue) {
+			request->Cancel();
+		}
+	}
+
+	for (auto& request : requests) {
+		request->Cancel();
+	}
+
+	queueCondition.notify_all();
+
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+std::shared_ptr<ModelLoadRequest> ModelLoader::Load(const std::string& filePath, bool isPaged)
+{
+	std::shared_ptr<ModelLoadRequest> request = std::make_shared<ModelLoadRequest>(filePath, isPaged);
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		queue.push_back(request);
+	}
+
+	// The worker is only started once something has to be loaded
+	if (!worker.joinable()) {
+		worker = std::thread(&ModelLoader::WorkerLoop, this);
+	}
+
+	queueCondition.notify_one();
+	requests.push_back(request);
+
+	return request;
+}
+
+int ModelLoader::Poll(Scene* scene)
+{
+	int addedModels = 0;
+
+	for (auto it = requests.begin(); it != requests.end();)
+	{
+		std::shared_ptr<ModelLoadRequest> request = *it;
+
+		if (!request->IsDone()) {
+			addedModels += UpdatePreview(scene, request.get()) ? 1 : 0;
+			it++;
+			continue;
+		}
+
+		std::shared_ptr<MeshModel> model = request->result.get();
+		std::shared_ptr<MeshModel> previewModel = request->previewModel;
+		bool isLoaded = model && !request->IsCancelled();
+
+		// A preview takes the final geometry, so whatever was done to it meanwhile is kept. Paged models
+		// are drawn differently and replace their preview instead.
+		if (previewModel && isLoaded && !std::dynamic_pointer_cast<PagedMeshModel>(model)) {
+			previewModel->SetGeometry(model->GetGeometry());
+		}
+		else if (previewModel) {
+			if (isLoaded && scene->HasModel(previewModel)) {
+				model->SetModelTransformation(previewModel->GetModelTransformation());
+				scene->AddModel(model);
+				addedModels++;
+			}
+
+			scene->RemoveModel(previewModel);
+		}
+		else if (isLoaded) {
+			scene->AddModel(model);
+			addedModels++;
+		}
+
+		it = requests.erase(it);
+	}
+
+	return addedModels;
+}
+
+bool ModelLoader::UpdatePreview(Scene* scene, ModelLoadRequest* request)
+{
+	std::shared_ptr<const MeshGeometry> preview;
+
+	{
+		std::lock_guard<std::mutex> lock(request->progress.previewMutex);
+		preview = request->progress.preview;
+	}
+
+	if (!preview || request->IsCancelled()) {
+		return false;
+	}
+
+	// The preview model is created once, later versions only replace its geometry. Previews are replaced within
+	// moments, so no levels of detail are built for them.
+	if (!request->previewModel) {
+		request->previewModel = std::make_shared<MeshModel>(preview, Utils::GetFileName(request->filePath), false);
+		scene->AddModel(request->previewModel);
+		return true;
+	}
+
+	if (request->previewModel->GetGeometry() != preview) {
+		request->previewModel->SetGeometry(preview, false);
+	}
+
+	return false;
+}
+
+void ModelLoader::WorkerLoop()
+{
+	while (true)
+	{
+		std::shared_ptr<ModelLoadRequest> request;
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+			// Requests still waiting are completed without a model, so nobody waits on them forever
+			if (stopping) {
+				for (auto& queuedRequest : queue) {
+					queuedRequest->progress.fraction = 1.0f;
+					queuedRequest->promise.set_value(nullptr);
+				}
+
+				queue.clear();
+				return;
+			}
+
+			request = queue.front();
+			queue.pop_front();
+		}
+
+		std::shared_ptr<MeshModel> model;
+
+		// A load that throws (out of memory, a parser error) fails like any other load instead of ending the program
+		try
+		{
+			if (!request->IsCancelled() && request->isPaged) {
+				model = Utils::LoadPagedMeshModel(request->filePath, &request->progress);
+			}
+			else if (!request->IsCancelled()) {
+				model = Utils::LoadMeshModel(request->filePath, &request->progress);
+			}
+
+			// Large meshes get their hierarchy here rather than on the first pick or frame that needs it
+			if (model && !request->IsCancelled() && model->GetGeometry()->GetIndexBuffer().size() / FACE_ELEMENTS >= BVH_MIN_FACES) {
+				model->GetGeometry()->GetBvh();
+			}
+		}
+		catch (const std::exception& exception)
+		{
+			fprintf(stderr, "Could not load %s: %s\n", Utils::GetFileName(request->filePath).c_str(), exception.what());
+			model = nullptr;
+		}
+		catch (...)
+		{
+			fprintf(stderr, "Could not load %s\n", Utils::GetFileName(request->filePath).c_str());
+			model = nullptr;
+		}
+
+		request->progress.fraction = 1.0f;
+		request->promise.set_value(request->IsCancelled() ? nullptr : model);
+	}
+}
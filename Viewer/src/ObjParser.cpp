@@ -0,0 +1,782 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <Windows.h>
+
+#define IS_DIGIT(c)							((c) >= '0' && (c) <= '9')
+#define IS_BLANK(c)							((c) == ' ' || (c) == '\t' || (c) == '\r')
+#define MAX_MANTISSA						1000000000000000000ULL
+#define BENCHMARK_REPETITIONS				5
+#define PARALLEL_PARSE_THRESHOLD			(8 * 1024 * 1024)
+#define MIN_CHUNK_SIZE						(1024 * 1024)
+// The example models are below MIN_CHUNK_SIZE, the benchmark splits them into smaller chunks so the parallel path is measured
+#define BENCHMARK_MIN_CHUNK_SIZE			(16 * 1024)
+// The example models fit in a single bounds block, their vertices are repeated up to this count to check the parallel reduction
+#define BENCHMARK_BOUNDS_VERTICES			(1024 * 1024)
+#define PROGRESS_STEP						(256 * 1024)
+#define PREVIEW_INTERVAL_MS					100
+
+// A face of a chunk that uses negative indices. These are relative to the elements read before the face,
+// which are only known once all of the previous chunks were parsed.
+typedef struct _RELATIVE_FACE_
+{
+	size_t face;
+	int vertexIndices[FACE_ELEMENTS];
+	int textureIndices[FACE_ELEMENTS];
+	int normalIndices[FACE_ELEMENTS];
+	size_t vertexCount;
+	size_t textureCount;
+	size_t normalCount;
+
+} RELATIVE_FACE, *PRELATIVE_FACE;
+
+typedef struct _OBJ_CHUNK_
+{
+	const char* begin;
+	const char* end;
+	MESH_DATA meshData;
+	std::vector<RELATIVE_FACE> relativeFaces;
+
+} OBJ_CHUNK, *POBJ_CHUNK;
+
+// Progress of one parse, shared by all of its chunks
+typedef struct _PARSE_PROGRESS_
+{
+	PLOAD_PROGRESS loadProgress;
+	std::atomic<size_t> parsedBytes;
+	size_t totalBytes;
+	// Raw bounds of the vertices parsed so far, published as the first preview of the model
+	std::mutex boundsMutex;
+	glm::vec3 minCoordinates;
+	glm::vec3 maxCoordinates;
+	double coordinatesSum[3];
+	size_t vertexCount;
+	std::chrono::steady_clock::time_point published;
+
+} PARSE_PROGRESS, *PPARSE_PROGRESS;
+
+static const double POWERS_OF_TEN[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char* SkipBlanks(const char* cursor, const char* end)
+{
+	while (cursor < end && IS_BLANK(*cursor)) {
+		cursor++;
+	}
+
+	return cursor;
+}
+
+static const char* SkipLine(const char* cursor, const char* end)
+{
+	const char* newLine = (const char*) memchr(cursor, '\n', end - cursor);
+	return newLine ? newLine + 1 : end;
+}
+
+static void InitParseProgress(PARSE_PROGRESS& parseProgress, PLOAD_PROGRESS progress, size_t totalBytes)
+{
+	parseProgress.loadProgress = progress;
+	parseProgress.parsedBytes = 0;
+	parseProgress.totalBytes = totalBytes;
+	parseProgress.minCoordinates = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+	parseProgress.maxCoordinates = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	parseProgress.coordinatesSum[0] = parseProgress.coordinatesSum[1] = parseProgress.coordinatesSum[2] = 0;
+	parseProgress.vertexCount = 0;
+	parseProgress.published = std::chrono::steady_clock::time_point();
+}
+
+// Adds the vertices read since the last report to the bounds and, every PREVIEW_INTERVAL_MS, publishes the bounds as the model preview
+static void PublishBounds(PPARSE_PROGRESS parseProgress, const glm::vec3* vertices, size_t count)
+{
+	glm::vec3 minCoordinates = vertices[0];
+	glm::vec3 maxCoordinates = vertices[0];
+	double coordinatesSum[3] = { 0, 0, 0 };
+
+	for (size_t i = 0; i < count; i++) {
+		minCoordinates = glm::min(minCoordinates, vertices[i]);
+		maxCoordinates = glm::max(maxCoordinates, vertices[i]);
+		coordinatesSum[0] += vertices[i].x;
+		coordinatesSum[1] += vertices[i].y;
+		coordinatesSum[2] += vertices[i].z;
+	}
+
+	std::lock_guard<std::mutex> lock(parseProgress->boundsMutex);
+
+	parseProgress->minCoordinates = glm::min(parseProgress->minCoordinates, minCoordinates);
+	parseProgress->maxCoordinates = glm::max(parseProgress->maxCoordinates, maxCoordinates);
+	parseProgress->vertexCount += count;
+
+	for (int axis = 0; axis < 3; axis++) {
+		parseProgress->coordinatesSum[axis] += coordinatesSum[axis];
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (now - parseProgress->published < std::chrono::milliseconds(PREVIEW_INTERVAL_MS)) {
+		return;
+	}
+
+	glm::vec3 centroid(
+		(float) (parseProgress->coordinatesSum[0] / parseProgress->vertexCount),
+		(float) (parseProgress->coordinatesSum[1] / parseProgress->vertexCount),
+		(float) (parseProgress->coordinatesSum[2] / parseProgress->vertexCount));
+	minCoordinates = parseProgress->minCoordinates;
+	maxCoordinates = parseProgress->maxCoordinates;
+	MeshGeometry::NormalizeBounds(centroid, minCoordinates, maxCoordinates);
+
+	std::shared_ptr<const MeshGeometry> preview = std::make_shared<MeshGeometry>(centroid, minCoordinates, maxCoordinates);
+	std::lock_guard<std::mutex> previewLock(parseProgress->loadProgress->previewMutex);
+	parseProgress->loadProgress->preview = preview;
+	parseProgress->published = now;
+}
+
+// Returns false once the load was cancelled
+static bool ReportProgress(PPARSE_PROGRESS parseProgress, size_t parsedBytes, const std::vector<glm::vec3>& vertices, size_t& reportedVertices)
+{
+	size_t totalParsedBytes = parseProgress->parsedBytes += parsedBytes;
+	parseProgress->loadProgress->fraction = parseProgress->totalBytes > 0 ? (float) totalParsedBytes / parseProgress->totalBytes : 1.0f;
+
+	if (reportedVertices < vertices.size()) {
+		PublishBounds(parseProgress, vertices.data() + reportedVertices, vertices.size() - reportedVertices);
+		reportedVertices = vertices.size();
+	}
+
+	return !parseProgress->loadProgress->cancelled;
+}
+
+// OBJ indices are 1-based, negative values are relative to the elements read so far and 0 marks a missing element.
+// Resolved indices are 0-based, with -1 for missing elements.
+static int ResolveIndex(int index, size_t count)
+{
+	return index < 0 ? (int) count + index : index - 1;
+}
+
+// Normal and texture indices are only stored once some face uses them, earlier faces are then padded as missing
+static void AppendOptionalIndices(std::vector<int>& indices, const int faceIndices[], size_t faceCount)
+{
+	if (indices.empty() && faceIndices[0] < 0 && faceIndices[1] < 0 && faceIndices[2] < 0) {
+		return;
+	}
+
+	indices.resize(faceCount * FACE_ELEMENTS, -1);
+	indices.insert(indices.end(), faceIndices, faceIndices + FACE_ELEMENTS);
+}
+
+static void PadOptionalIndices(std::vector<int>& indices, size_t faceCount)
+{
+	if (!indices.empty()) {
+		indices.resize(faceCount * FACE_ELEMENTS, -1);
+	}
+}
+
+// Resolved indices have to name an element that was read, only normal and texture indices may be missing
+static bool AreIndicesValid(const std::vector<int>& indices, size_t count, bool isOptional)
+{
+	for each (int index in indices) {
+		if (isOptional && index == -1) {
+			continue;
+		}
+
+		if (index < 0 || (size_t) index >= count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static RETURN_VALUE ValidateIndices(const MESH_DATA& meshData)
+{
+	if (!AreIndicesValid(meshData.vertexIndices, meshData.vertices.size(), false) ||
+		!AreIndicesValid(meshData.normalIndices, meshData.normals.size(), true) ||
+		!AreIndicesValid(meshData.textureIndices, meshData.textureVertices.size(), true)) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+static const char* ParseVec3(const char* cursor, const char* end, glm::vec3& vector)
+{
+	cursor = ObjParser::ParseFloat(SkipBlanks(cursor, end), end, vector.x);
+	cursor = ObjParser::ParseFloat(SkipBlanks(cursor, end), end, vector.y);
+	cursor = ObjParser::ParseFloat(SkipBlanks(cursor, end), end, vector.z);
+	return cursor;
+}
+
+static const char* ParseVec2(const char* cursor, const char* end, glm::vec2& vector)
+{
+	cursor = ObjParser::ParseFloat(SkipBlanks(cursor, end), end, vector.x);
+	cursor = ObjParser::ParseFloat(SkipBlanks(cursor, end), end, vector.y);
+	return cursor;
+}
+
+// Reads the first three "v", "v/t", "v//n" or "v/t/n" groups of a face record
+static const char* ParseFace(const char* cursor, const char* end, MESH_DATA& meshData, std::vector<RELATIVE_FACE>* relativeFaces)
+{
+	int vertexIndices[FACE_ELEMENTS] = { 0, 0, 0 };
+	int textureIndices[FACE_ELEMENTS] = { 0, 0, 0 };
+	int normalIndices[FACE_ELEMENTS] = { 0, 0, 0 };
+
+	for (int i = 0; i < FACE_ELEMENTS; i++)
+	{
+		cursor = ObjParser::ParseInt(SkipBlanks(cursor, end), end, vertexIndices[i]);
+
+		if (cursor >= end || *cursor != '/')
+		{
+			continue;
+		}
+
+		cursor++;
+
+		if (cursor < end && *cursor != '/')
+		{
+			cursor = ObjParser::ParseInt(cursor, end, textureIndices[i]);
+		}
+
+		if (cursor < end && *cursor == '/')
+		{
+			cursor = ObjParser::ParseInt(cursor + 1, end, normalIndices[i]);
+		}
+	}
+
+	// Chunks defer faces with relative indices to the merge step
+	if (relativeFaces && (vertexIndices[0] < 0 || vertexIndices[1] < 0 || vertexIndices[2] < 0 ||
+		textureIndices[0] < 0 || textureIndices[1] < 0 || textureIndices[2] < 0 ||
+		normalIndices[0] < 0 || normalIndices[1] < 0 || normalIndices[2] < 0))
+	{
+		RELATIVE_FACE relativeFace = { meshData.vertexIndices.size() / FACE_ELEMENTS };
+		std::copy(vertexIndices, vertexIndices + FACE_ELEMENTS, relativeFace.vertexIndices);
+		std::copy(textureIndices, textureIndices + FACE_ELEMENTS, relativeFace.textureIndices);
+		std::copy(normalIndices, normalIndices + FACE_ELEMENTS, relativeFace.normalIndices);
+		relativeFace.vertexCount = meshData.vertices.size();
+		relativeFace.textureCount = meshData.textureVertices.size();
+		relativeFace.normalCount = meshData.normals.size();
+		relativeFaces->push_back(relativeFace);
+	}
+
+	for (int i = 0; i < FACE_ELEMENTS; i++)
+	{
+		vertexIndices[i] = ResolveIndex(vertexIndices[i], meshData.vertices.size());
+		textureIndices[i] = ResolveIndex(textureIndices[i], meshData.textureVertices.size());
+		normalIndices[i] = ResolveIndex(normalIndices[i], meshData.normals.size());
+	}
+
+	size_t faceCount = meshData.vertexIndices.size() / FACE_ELEMENTS;
+	meshData.vertexIndices.insert(meshData.vertexIndices.end(), vertexIndices, vertexIndices + FACE_ELEMENTS);
+	AppendOptionalIndices(meshData.normalIndices, normalIndices, faceCount);
+	AppendOptionalIndices(meshData.textureIndices, textureIndices, faceCount);
+
+	return cursor;
+}
+
+// Reads the position indices of the first three groups of a face record, skipping texture and normal indices
+static const char* ParseFaceVertices(const char* cursor, const char* end, int vertexIndices[])
+{
+	int ignored;
+
+	for (int i = 0; i < FACE_ELEMENTS; i++)
+	{
+		vertexIndices[i] = 0;
+		cursor = ObjParser::ParseInt(SkipBlanks(cursor, end), end, vertexIndices[i]);
+
+		while (cursor < end && *cursor == '/')
+		{
+			cursor = ObjParser::ParseInt(cursor + 1, end, ignored);
+		}
+	}
+
+	return cursor;
+}
+
+RETURN_VALUE ObjParser::ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	MappedFile file;
+
+	if (file.Open(filePath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	if (file.GetSize() >= PARALLEL_PARSE_THRESHOLD) {
+		return ParseParallel(file.GetData(), file.GetEnd(), meshData, std::thread::hardware_concurrency(), progress);
+	}
+
+	return Parse(file.GetData(), file.GetEnd(), meshData, progress);
+}
+
+static bool ParseRange(const char* cursor, const char* end, MESH_DATA& meshData, std::vector<RELATIVE_FACE>* relativeFaces, PPARSE_PROGRESS parseProgress)
+{
+	const char* reported = cursor;
+	size_t reportedVertices = meshData.vertices.size();
+
+	while (cursor < end)
+	{
+		if (parseProgress && cursor - reported >= PROGRESS_STEP)
+		{
+			if (!ReportProgress(parseProgress, cursor - reported, meshData.vertices, reportedVertices)) {
+				return false;
+			}
+
+			reported = cursor;
+		}
+
+		// read the type of the line
+		cursor = SkipBlanks(cursor, end);
+		const char* lineType = cursor;
+
+		while (cursor < end && !IS_BLANK(*cursor) && *cursor != '\n') {
+			cursor++;
+		}
+
+		size_t lineTypeLength = cursor - lineType;
+
+		// based on the type parse data
+		if (lineTypeLength == 1 && lineType[0] == 'v')
+		{
+			glm::vec3 vertex;
+			cursor = ParseVec3(cursor, end, vertex);
+			meshData.vertices.push_back(vertex);
+		}
+		else if (lineTypeLength == 2 && lineType[0] == 'v' && lineType[1] == 'n')
+		{
+			glm::vec3 normal;
+			cursor = ParseVec3(cursor, end, normal);
+			meshData.normals.push_back(normal);
+		}
+		else if (lineTypeLength == 2 && lineType[0] == 'v' && lineType[1] == 't')
+		{
+			glm::vec2 textureVertex;
+			cursor = ParseVec2(cursor, end, textureVertex);
+			meshData.textureVertices.push_back(textureVertex);
+		}
+		else if (lineTypeLength == 1 && lineType[0] == 'f')
+		{
+			cursor = ParseFace(cursor, end, meshData, relativeFaces);
+		}
+		else if (lineTypeLength == 0 || lineType[0] == '#')
+		{
+			// comment / empty line
+		}
+		else
+		{
+			std::cout << "Found unknown line Type \"" << std::string(lineType, lineTypeLength) << "\"";
+		}
+
+		cursor = SkipLine(cursor, end);
+	}
+
+	PadOptionalIndices(meshData.normalIndices, meshData.vertexIndices.size() / FACE_ELEMENTS);
+	PadOptionalIndices(meshData.textureIndices, meshData.vertexIndices.size() / FACE_ELEMENTS);
+
+	return !parseProgress || ReportProgress(parseProgress, cursor - reported, meshData.vertices, reportedVertices);
+}
+
+RETURN_VALUE ObjParser::Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	PARSE_PROGRESS parseProgress;
+	InitParseProgress(parseProgress, progress, end - begin);
+
+	if (!ParseRange(begin, end, meshData, nullptr, progress ? &parseProgress : nullptr)) {
+		return FAILURE;
+	}
+
+	return ValidateIndices(meshData);
+}
+
+static RETURN_VALUE ParseChunks(const char* begin, const char* end, MESH_DATA& meshData, unsigned int threadCount, size_t minChunkSize, PLOAD_PROGRESS progress)
+{
+	size_t size = end - begin;
+	size_t chunkCount = threadCount;
+
+	// Don't bother spawning threads for chunks that are parsed faster than a thread starts
+	if (chunkCount > size / minChunkSize) {
+		chunkCount = size / minChunkSize;
+	}
+
+	if (chunkCount <= 1) {
+		return ObjParser::Parse(begin, end, meshData, progress);
+	}
+
+	// Split the input into newline aligned chunks of about the same size
+	std::vector<OBJ_CHUNK> chunks(chunkCount);
+	const char* chunkBegin = begin;
+
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* chunkEnd = begin + size * (i + 1) / chunkCount;
+
+		if (i == chunkCount - 1) {
+			chunkEnd = end;
+		}
+		else if (chunkEnd > chunkBegin) {
+			chunkEnd = SkipLine(chunkEnd, end);
+		}
+		else {
+			chunkEnd = chunkBegin;
+		}
+
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	PARSE_PROGRESS parseProgress;
+	InitParseProgress(parseProgress, progress, size);
+	PPARSE_PROGRESS sharedProgress = progress ? &parseProgress : nullptr;
+	std::vector<std::thread> workers;
+
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		POBJ_CHUNK chunk = &chunks[i];
+		workers.push_back(std::thread([chunk, sharedProgress]() { ParseRange(chunk->begin, chunk->end, chunk->meshData, &chunk->relativeFaces, sharedProgress); }));
+	}
+
+	ParseRange(chunks[0].begin, chunks[0].end, chunks[0].meshData, &chunks[0].relativeFaces, sharedProgress);
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	if (progress && progress->cancelled) {
+		return FAILURE;
+	}
+
+	// Merge the chunks in file order, so indices keep pointing at the same elements as in a serial parse
+	size_t indicesCount = meshData.vertexIndices.size();
+	size_t verticesCount = meshData.vertices.size();
+	size_t normalsCount = meshData.normals.size();
+	size_t textureVerticesCount = meshData.textureVertices.size();
+	bool hasNormalIndices = !meshData.normalIndices.empty();
+	bool hasTextureIndices = !meshData.textureIndices.empty();
+
+	for (auto& chunk : chunks)
+	{
+		indicesCount += chunk.meshData.vertexIndices.size();
+		verticesCount += chunk.meshData.vertices.size();
+		normalsCount += chunk.meshData.normals.size();
+		textureVerticesCount += chunk.meshData.textureVertices.size();
+		hasNormalIndices |= !chunk.meshData.normalIndices.empty();
+		hasTextureIndices |= !chunk.meshData.textureIndices.empty();
+
+		// A relative index resolves below zero inside a later chunk, so its face may not have stored it yet
+		for (auto& relativeFace : chunk.relativeFaces)
+		{
+			for (int i = 0; i < FACE_ELEMENTS; i++)
+			{
+				hasNormalIndices |= relativeFace.normalIndices[i] < 0;
+				hasTextureIndices |= relativeFace.textureIndices[i] < 0;
+			}
+		}
+	}
+
+	meshData.vertexIndices.reserve(indicesCount);
+	meshData.vertices.reserve(verticesCount);
+	meshData.normals.reserve(normalsCount);
+	meshData.textureVertices.reserve(textureVerticesCount);
+
+	if (hasNormalIndices) {
+		meshData.normalIndices.reserve(indicesCount);
+	}
+
+	if (hasTextureIndices) {
+		meshData.textureIndices.reserve(indicesCount);
+	}
+
+	for (auto& chunk : chunks)
+	{
+		size_t indexOffset = meshData.vertexIndices.size();
+		size_t vertexOffset = meshData.vertices.size();
+		size_t normalOffset = meshData.normals.size();
+		size_t textureOffset = meshData.textureVertices.size();
+		size_t chunkIndicesCount = chunk.meshData.vertexIndices.size();
+
+		meshData.vertexIndices.insert(meshData.vertexIndices.end(), chunk.meshData.vertexIndices.begin(), chunk.meshData.vertexIndices.end());
+		meshData.vertices.insert(meshData.vertices.end(), chunk.meshData.vertices.begin(), chunk.meshData.vertices.end());
+		meshData.normals.insert(meshData.normals.end(), chunk.meshData.normals.begin(), chunk.meshData.normals.end());
+		meshData.textureVertices.insert(meshData.textureVertices.end(), chunk.meshData.textureVertices.begin(), chunk.meshData.textureVertices.end());
+
+		// Chunks without normal or texture indices are padded as missing when other chunks have them
+		if (hasNormalIndices) {
+			meshData.normalIndices.insert(meshData.normalIndices.end(), chunk.meshData.normalIndices.begin(), chunk.meshData.normalIndices.end());
+			meshData.normalIndices.resize(indexOffset + chunkIndicesCount, -1);
+		}
+
+		if (hasTextureIndices) {
+			meshData.textureIndices.insert(meshData.textureIndices.end(), chunk.meshData.textureIndices.begin(), chunk.meshData.textureIndices.end());
+			meshData.textureIndices.resize(indexOffset + chunkIndicesCount, -1);
+		}
+
+		for (auto& relativeFace : chunk.relativeFaces)
+		{
+			size_t faceIndex = indexOffset + relativeFace.face * FACE_ELEMENTS;
+
+			for (int i = 0; i < FACE_ELEMENTS; i++)
+			{
+				meshData.vertexIndices[faceIndex + i] = ResolveIndex(relativeFace.vertexIndices[i], vertexOffset + relativeFace.vertexCount);
+
+				if (hasNormalIndices) {
+					meshData.normalIndices[faceIndex + i] = ResolveIndex(relativeFace.normalIndices[i], normalOffset + relativeFace.normalCount);
+				}
+
+				if (hasTextureIndices) {
+					meshData.textureIndices[faceIndex + i] = ResolveIndex(relativeFace.textureIndices[i], textureOffset + relativeFace.textureCount);
+				}
+			}
+		}
+
+		chunk.meshData = MESH_DATA();
+	}
+
+	return ValidateIndices(meshData);
+}
+
+RETURN_VALUE ObjParser::ParseParallel(const char* begin, const char* end, MESH_DATA& meshData, unsigned int threadCount, PLOAD_PROGRESS progress)
+{
+	return ParseChunks(begin, end, meshData, threadCount, MIN_CHUNK_SIZE, progress);
+}
+
+RETURN_VALUE ObjParser::Scan(const std::string& filePath, const std::function<void(const glm::vec3&)>& onVertex, const std::function<void(const int*)>& onFace,
+	PLOAD_PROGRESS progress, float progressBegin, float progressEnd)
+{
+	MappedFile file;
+
+	if (file.Open(filePath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	const char* cursor = file.GetData();
+	const char* end = file.GetEnd();
+	const char* reported = cursor;
+	size_t vertexCount = 0;
+
+	while (cursor < end)
+	{
+		if (progress && cursor - reported >= PROGRESS_STEP)
+		{
+			progress->fraction = progressBegin + (progressEnd - progressBegin) * (float) (cursor - file.GetData()) / file.GetSize();
+
+			if (progress->cancelled) {
+				return FAILURE;
+			}
+
+			reported = cursor;
+		}
+
+		// Only "v" and "f" records are read, everything else is skipped
+		cursor = SkipBlanks(cursor, end);
+
+		if (end - cursor >= 2 && cursor[0] == 'v' && IS_BLANK(cursor[1]))
+		{
+			glm::vec3 vertex;
+			cursor = ParseVec3(cursor + 1, end, vertex);
+			onVertex(vertex);
+			vertexCount++;
+		}
+		else if (end - cursor >= 2 && cursor[0] == 'f' && IS_BLANK(cursor[1]))
+		{
+			int vertexIndices[FACE_ELEMENTS];
+			cursor = ParseFaceVertices(cursor + 1, end, vertexIndices);
+
+			for (int i = 0; i < FACE_ELEMENTS; i++) {
+				vertexIndices[i] = ResolveIndex(vertexIndices[i], vertexCount);
+			}
+
+			onFace(vertexIndices);
+		}
+
+		cursor = SkipLine(cursor, end);
+	}
+
+	if (progress) {
+		progress->fraction = progressEnd;
+	}
+
+	return SUCCESS;
+}
+
+const char* ObjParser::ParseFloat(const char* cursor, const char* end, float& value)
+{
+	bool negative = false;
+
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+		negative = (*cursor == '-');
+		cursor++;
+	}
+
+	// Accumulate the significant digits as an integer, the decimal point only moves the exponent
+	uint64_t mantissa = 0;
+	int exponent = 0;
+
+	for (; cursor < end && IS_DIGIT(*cursor); cursor++) {
+		if (mantissa < MAX_MANTISSA) {
+			mantissa = mantissa * 10 + (*cursor - '0');
+		}
+		else {
+			exponent++;
+		}
+	}
+
+	if (cursor < end && *cursor == '.') {
+		for (cursor++; cursor < end && IS_DIGIT(*cursor); cursor++) {
+			if (mantissa < MAX_MANTISSA) {
+				mantissa = mantissa * 10 + (*cursor - '0');
+				exponent--;
+			}
+		}
+	}
+
+	if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+		int explicitExponent = 0;
+		cursor = ParseInt(cursor + 1, end, explicitExponent);
+		exponent += explicitExponent;
+	}
+
+	// Both operands are exact for short mantissas, so a single multiplication or division rounds correctly
+	double result = (double) mantissa;
+
+	while (exponent > 22) {
+		result *= POWERS_OF_TEN[22];
+		exponent -= 22;
+	}
+
+	while (exponent < -22) {
+		result /= POWERS_OF_TEN[22];
+		exponent += 22;
+	}
+
+	result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+	value = (float) (negative ? -result : result);
+
+	return cursor;
+}
+
+const char* ObjParser::ParseInt(const char* cursor, const char* end, int& value)
+{
+	bool negative = false;
+
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+		negative = (*cursor == '-');
+		cursor++;
+	}
+
+	int result = 0;
+
+	for (; cursor < end && IS_DIGIT(*cursor); cursor++) {
+		result = result * 10 + (*cursor - '0');
+	}
+
+	value = negative ? -result : result;
+
+	return cursor;
+}
+
+template <typename T>
+static bool IsIdentical(const std::vector<T>& first, const std::vector<T>& second)
+{
+	return first.size() == second.size() && (first.empty() || memcmp(first.data(), second.data(), first.size() * sizeof(T)) == 0);
+}
+
+static bool IsIdentical(const MESH_DATA& first, const MESH_DATA& second)
+{
+	return IsIdentical(first.vertices, second.vertices) && IsIdentical(first.normals, second.normals) && IsIdentical(first.textureVertices, second.textureVertices) &&
+		IsIdentical(first.vertexIndices, second.vertexIndices) && IsIdentical(first.normalIndices, second.normalIndices) && IsIdentical(first.textureIndices, second.textureIndices);
+}
+
+// Compares the parallel bounds of the vertices, repeated over many blocks, with the serial reference
+static bool MatchesReferenceBounds(const std::vector<glm::vec3>& vertices)
+{
+	std::vector<glm::vec3> repeated;
+	repeated.reserve(BENCHMARK_BOUNDS_VERTICES + vertices.size());
+
+	while (repeated.size() < BENCHMARK_BOUNDS_VERTICES) {
+		repeated.insert(repeated.end(), vertices.begin(), vertices.end());
+	}
+
+	return MeshGeometry::MatchesReferenceBounds(repeated);
+}
+
+void ObjParser::Benchmark(const std::string& directory)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((directory + "\\*.obj").c_str(), &findData);
+
+	if (findHandle == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "No .obj files were found in %s\n", directory.c_str());
+		return;
+	}
+
+	unsigned int threadCount = std::thread::hardware_concurrency();
+
+	printf("%-20s %12s %14s %16s %14s %10s %10s\n", "Model", "Size (KB)", "Parse (MB/s)", "Parallel (MB/s)", "Build (MB/s)", "Identical", "Reference");
+
+	double totalMegabytes = 0;
+	double totalParseSeconds = 0;
+	double totalParallelSeconds = 0;
+	double totalBuildSeconds = 0;
+
+	do
+	{
+		std::string filePath = directory + "\\" + findData.cFileName;
+		MappedFile file;
+
+		if (file.Open(filePath) != SUCCESS) {
+			continue;
+		}
+
+		double megabytes = file.GetSize() / (1024.0 * 1024.0);
+		double parseSeconds = DBL_MAX;
+		double parallelSeconds = DBL_MAX;
+		double buildSeconds = DBL_MAX;
+		bool isIdentical = true;
+		bool matchesReference = true;
+
+		// Keep the best of a few runs so the numbers reflect a warm file cache
+		for (int i = 0; i < BENCHMARK_REPETITIONS; i++)
+		{
+			MESH_DATA serialData;
+			MESH_DATA parallelData;
+			auto start = std::chrono::high_resolution_clock::now();
+			Parse(file.GetData(), file.GetEnd(), serialData);
+			auto parsed = std::chrono::high_resolution_clock::now();
+			ParseChunks(file.GetData(), file.GetEnd(), parallelData, threadCount, BENCHMARK_MIN_CHUNK_SIZE, nullptr);
+			auto parallelParsed = std::chrono::high_resolution_clock::now();
+			isIdentical = isIdentical && IsIdentical(serialData, parallelData);
+			auto compared = std::chrono::high_resolution_clock::now();
+			MeshGeometry geometry(std::move(serialData));
+			auto built = std::chrono::high_resolution_clock::now();
+			// The parallel bounds and the welding are checked against the serial reference, outside of the timing
+			matchesReference = matchesReference && geometry.MatchesReference(parallelData);
+
+			if (i == 0 && !parallelData.vertices.empty()) {
+				matchesReference = matchesReference && MatchesReferenceBounds(parallelData.vertices);
+			}
+
+			parseSeconds = fmin(parseSeconds, std::chrono::duration<double>(parsed - start).count());
+			parallelSeconds = fmin(parallelSeconds, std::chrono::duration<double>(parallelParsed - parsed).count());
+			buildSeconds = fmin(buildSeconds, std::chrono::duration<double>(built - compared).count());
+		}
+
+		printf("%-20s %12.1f %14.1f %16.1f %14.1f %10s %10s\n", findData.cFileName, megabytes * 1024.0, megabytes / parseSeconds, megabytes / parallelSeconds, megabytes / buildSeconds,
+			isIdentical ? "yes" : "no", matchesReference ? "yes" : "no");
+
+		totalMegabytes += megabytes;
+		totalParseSeconds += parseSeconds;
+		totalParallelSeconds += parallelSeconds;
+		totalBuildSeconds += buildSeconds;
+
+	} while (FindNextFileA(findHandle, &findData));
+
+	FindClose(findHandle);
+
+	printf("%-20s %12.1f %14.1f %16.1f %14.1f\n", "Total", totalMegabytes * 1024.0, totalMegabytes / totalParseSeconds, totalMegabytes / totalParallelSeconds, totalMegabytes / totalBuildSeconds);
+}
@@ -0,0 +1,697 @@
+#include "PagedMesh.h"
+#include "Constants.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <Windows.h>
+
+#define PAGED_MESH_MAGIC					"MSHP"
+#define PAGED_MESH_VERSION					1
+#define PAGED_MESH_EXTENSION				".meshpages"
+#define ALIGN4(size)						(((size) + 3) & ~(size_t) 3)
+#define PAGED_MESH_PROGRESS_STEP			65536
+
+// A triangle of the source while the page file is built, with the cell it belongs to
+typedef struct _PAGED_TRIANGLE_
+{
+	uint32_t cell;
+	uint32_t vertexIndices[FACE_ELEMENTS];
+} PAGED_TRIANGLE, *PPAGED_TRIANGLE;
+
+// The temporary files of a build, deleted however the build ends
+typedef struct _PAGED_BUILD_FILES_
+{
+	std::vector<std::string> paths;
+
+	~_PAGED_BUILD_FILES_()
+	{
+		for each (const std::string& path in paths) {
+			DeleteFileA(path.c_str());
+		}
+	}
+} PAGED_BUILD_FILES, *PPAGED_BUILD_FILES;
+
+PagedMesh::PagedMesh() :
+	faceCount(0),
+	byteBudget(0),
+	residentBytes(0),
+	frame(0),
+	centroid({ 0, 0, 0 }),
+	minCoordinates({ 0, 0, 0 }),
+	maxCoordinates({ 0, 0, 0 }),
+	stopping(false)
+{
+
+}
+
+PagedMesh::~PagedMesh()
+{
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		stopping = true;
+	}
+
+	loadCondition.notify_all();
+
+	if (loader.joinable()) {
+		loader.join();
+	}
+}
+
+bool PagedMesh::FillHeader(const std::string& sourcePath, PAGED_MESH_HEADER& header)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if (!GetFileAttributesExA(sourcePath.c_str(), GetFileExInfoStandard, &attributes)) {
+		return false;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PAGED_MESH_MAGIC, sizeof(header.magic));
+	header.version = PAGED_MESH_VERSION;
+	header.sourceSize = ((uint64_t) attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	header.sourceModifiedTime = ((uint64_t) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	header.sourcePathLength = (uint32_t) sourcePath.size();
+
+	return true;
+}
+
+std::string PagedMesh::GetPagePath(const std::string& sourcePath)
+{
+	return sourcePath + PAGED_MESH_EXTENSION;
+}
+
+uint64_t PagedMesh::GetChunkBytes(const PAGED_CHUNK_ENTRY& entry)
+{
+	return (uint64_t) entry.vertexCount * sizeof(glm::vec3) + (uint64_t) entry.indexCount * sizeof(uint32_t);
+}
+
+uint64_t PagedMesh::GetResidentChunkBytes(const PAGED_CHUNK_ENTRY& entry)
+{
+	// A triangle adds at most three edges of two indices each
+	return GetChunkBytes(entry) + (uint64_t) entry.indexCount * 2 * sizeof(uint32_t);
+}
+
+RETURN_VALUE PagedMesh::Build(const std::string& sourcePath, const MESH_SCAN& scan, PLOAD_PROGRESS progress)
+{
+	PAGED_MESH_HEADER header;
+
+	if (!FillHeader(sourcePath, header)) {
+		return IO_ERROR;
+	}
+
+	// Declared first, so the files are closed before they are deleted
+	PAGED_BUILD_FILES temporaryFiles;
+	std::string pagePath = GetPagePath(sourcePath);
+	std::string vertexPath = pagePath + ".vertices.tmp";
+	std::string trianglePath = pagePath + ".triangles.tmp";
+	temporaryFiles.paths.push_back(vertexPath);
+	temporaryFiles.paths.push_back(trianglePath);
+
+	// First pass: the raw positions are spilled to disk while their bounds and centroid are gathered
+	std::ofstream vertexOutput(vertexPath.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (vertexOutput.fail()) {
+		return IO_ERROR;
+	}
+
+	uint64_t vertexCount = 0;
+	uint64_t sourceFaceCount = 0;
+	double sum[3] = { 0, 0, 0 };
+	glm::vec3 minCoordinates(FLT_MAX, FLT_MAX, FLT_MAX);
+	glm::vec3 maxCoordinates(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	RETURN_VALUE result = scan([&](const glm::vec3& vertex) {
+		vertexOutput.write((const char*) &vertex, sizeof(vertex));
+		minCoordinates = glm::min(minCoordinates, vertex);
+		maxCoordinates = glm::max(maxCoordinates, vertex);
+
+		for (int axis = 0; axis < 3; axis++) {
+			sum[axis] += vertex[axis];
+		}
+
+		vertexCount++;
+	}, [&](const int*) {
+		sourceFaceCount++;
+	}, 0.0f, 0.35f);
+
+	vertexOutput.close();
+
+	if (result != SUCCESS) {
+		return result;
+	}
+
+	if (vertexOutput.fail() || vertexCount > UINT32_MAX) {
+		return IO_ERROR;
+	}
+
+	glm::vec3 centroid(0, 0, 0);
+
+	if (vertexCount == 0) {
+		minCoordinates = maxCoordinates = centroid;
+	}
+	else {
+		centroid = glm::vec3((float) (sum[0] / vertexCount), (float) (sum[1] / vertexCount), (float) (sum[2] / vertexCount));
+	}
+
+	// Same normalization as MeshGeometry, applied to each position as it is written into its chunk
+	const glm::vec3 rawCentroid = centroid;
+	float absoluteMin = fmin(fmin(minCoordinates.x - centroid.x, minCoordinates.y - centroid.y), minCoordinates.z - centroid.z);
+	float absoluteMax = fmax(fmax(maxCoordinates.x - centroid.x, maxCoordinates.y - centroid.y), maxCoordinates.z - centroid.z);
+	MeshGeometry::NormalizeBounds(centroid, minCoordinates, maxCoordinates);
+
+	MappedFile vertexFile;
+
+	if (vertexFile.Open(vertexPath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	const glm::vec3* rawVertices = (const glm::vec3*) vertexFile.GetData();
+
+	// Meshes are surfaces, so roughly gridSize^2 of the cells end up holding triangles
+	int gridSize = (int) ceil(sqrt((double) (sourceFaceCount / PAGED_MESH_CHUNK_TRIANGLES + 1)));
+	gridSize = gridSize < PAGED_MESH_MAX_GRID_CELLS ? gridSize : PAGED_MESH_MAX_GRID_CELLS;
+	glm::vec3 cellSize = (maxCoordinates - minCoordinates) / (float) gridSize;
+	std::vector<uint64_t> cellStarts((size_t) gridSize * gridSize * gridSize + 1, 0);
+
+	// Second pass: every triangle goes to the cell holding its center, and is spilled to disk with its cell
+	std::ofstream triangleOutput(trianglePath.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (triangleOutput.fail()) {
+		return IO_ERROR;
+	}
+
+	uint64_t faceCount = 0;
+
+	result = scan([](const glm::vec3&) {}, [&](const int* vertexIndices) {
+		PAGED_TRIANGLE triangle;
+		glm::vec3 center(0, 0, 0);
+
+		// Faces referring to missing vertices are dropped, as MeshGeometry cannot draw them either
+		for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+			if (vertexIndices[corner] < 0 || (uint64_t) vertexIndices[corner] >= vertexCount) {
+				return;
+			}
+
+			triangle.vertexIndices[corner] = (uint32_t) vertexIndices[corner];
+			center += MeshGeometry::NormalizeVertex(rawVertices[vertexIndices[corner]], rawCentroid, absoluteMin, absoluteMax);
+		}
+
+		center /= 3.0f;
+		triangle.cell = 0;
+
+		for (int axis = 2; axis >= 0; axis--) {
+			int coordinate = cellSize[axis] > 0 ? (int) ((center[axis] - minCoordinates[axis]) / cellSize[axis]) : 0;
+			coordinate = coordinate < 0 ? 0 : (coordinate < gridSize ? coordinate : gridSize - 1);
+			triangle.cell = triangle.cell * gridSize + coordinate;
+		}
+
+		triangleOutput.write((const char*) &triangle, sizeof(triangle));
+		cellStarts[triangle.cell + 1]++;
+		faceCount++;
+	}, 0.35f, 0.7f);
+
+	triangleOutput.close();
+
+	if (result != SUCCESS) {
+		return result;
+	}
+
+	if (triangleOutput.fail()) {
+		return IO_ERROR;
+	}
+
+	// The triangles sorted by cell are cut into buckets small enough to be sorted in memory. A cell spanning
+	// two buckets becomes two chunks, so the chunk count is known before anything is written.
+	uint64_t bucketTriangles = (faceCount + PAGED_MESH_MAX_BUILD_BUCKETS - 1) / PAGED_MESH_MAX_BUILD_BUCKETS;
+	bucketTriangles = bucketTriangles > PAGED_MESH_BUILD_BUCKET_TRIANGLES ? bucketTriangles : PAGED_MESH_BUILD_BUCKET_TRIANGLES;
+	size_t bucketCount = (size_t) ((faceCount + bucketTriangles - 1) / bucketTriangles);
+	uint32_t chunkCount = 0;
+
+	for (size_t cell = 1; cell < cellStarts.size(); cell++) {
+		if (cellStarts[cell] > 0) {
+			chunkCount += (uint32_t) ((cellStarts[cell - 1] + cellStarts[cell] - 1) / bucketTriangles - cellStarts[cell - 1] / bucketTriangles + 1);
+		}
+
+		cellStarts[cell] += cellStarts[cell - 1];
+	}
+
+	std::vector<std::string> bucketPaths(1, trianglePath);
+
+	if (bucketCount > 1)
+	{
+		MappedFile triangleFile;
+		std::vector<std::ofstream> bucketOutputs(bucketCount);
+
+		if (triangleFile.Open(trianglePath) != SUCCESS) {
+			return IO_ERROR;
+		}
+
+		bucketPaths.clear();
+
+		for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+			bucketPaths.push_back(pagePath + ".bucket" + std::to_string(bucket) + ".tmp");
+			temporaryFiles.paths.push_back(bucketPaths.back());
+			bucketOutputs[bucket].open(bucketPaths.back().c_str(), std::ios::binary | std::ios::trunc);
+
+			if (bucketOutputs[bucket].fail()) {
+				return IO_ERROR;
+			}
+		}
+
+		const PAGED_TRIANGLE* triangles = (const PAGED_TRIANGLE*) triangleFile.GetData();
+		std::vector<uint64_t> cellCursors(cellStarts.begin(), cellStarts.end() - 1);
+
+		for (uint64_t i = 0; i < faceCount; i++) {
+			uint64_t rank = cellCursors[triangles[i].cell]++;
+			bucketOutputs[(size_t) (rank / bucketTriangles)].write((const char*) &triangles[i], sizeof(PAGED_TRIANGLE));
+
+			if (progress != nullptr && (i % PAGED_MESH_PROGRESS_STEP) == 0) {
+				if (progress->cancelled) {
+					return FAILURE;
+				}
+
+				progress->fraction = 0.7f + 0.1f * (float) i / (float) faceCount;
+			}
+		}
+
+		for each (std::ofstream& bucketOutput in bucketOutputs) {
+			bucketOutput.close();
+
+			if (bucketOutput.fail()) {
+				return IO_ERROR;
+			}
+		}
+	}
+
+	std::vector<uint64_t>().swap(cellStarts);
+
+	header.faceCount = faceCount;
+	header.chunkCount = chunkCount;
+
+	for (int i = 0; i < 3; i++) {
+		header.centroid[i] = centroid[i];
+		header.minCoordinates[i] = minCoordinates[i];
+		header.maxCoordinates[i] = maxCoordinates[i];
+	}
+
+	// Write next to the final file and rename it, like MeshCache does
+	std::string temporaryPath = pagePath + ".tmp";
+	temporaryFiles.paths.push_back(temporaryPath);
+	std::ofstream output(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (output.fail()) {
+		return IO_ERROR;
+	}
+
+	// The directory is written once the chunk offsets are known
+	const char padding[4] = { 0, 0, 0, 0 };
+	std::vector<PAGED_CHUNK_ENTRY> directory(chunkCount);
+	uint64_t directoryOffset = sizeof(header) + ALIGN4(sourcePath.size());
+
+	output.write((const char*) &header, sizeof(header));
+	output.write(sourcePath.c_str(), sourcePath.size());
+	output.write(padding, ALIGN4(sourcePath.size()) - sourcePath.size());
+	output.write((const char*) directory.data(), directory.size() * sizeof(PAGED_CHUNK_ENTRY));
+
+	std::vector<PAGED_TRIANGLE> bucketTriangleData;
+	std::unordered_map<uint32_t, uint32_t> localIndices;
+	std::vector<glm::vec3> chunkVertices;
+	std::vector<uint32_t> chunkIndices;
+	uint64_t chunkVertexCount = 0;
+	uint32_t chunk = 0;
+
+	for (size_t bucket = 0; bucket < bucketPaths.size(); bucket++)
+	{
+		std::ifstream bucketInput(bucketPaths[bucket].c_str(), std::ios::binary | std::ios::ate);
+		uint64_t bucketBytes = (uint64_t) bucketInput.tellg();
+		bucketInput.seekg(0, std::ios::beg);
+		bucketTriangleData.resize((size_t) (bucketBytes / sizeof(PAGED_TRIANGLE)));
+
+		if (bucketInput.fail() || !bucketInput.read((char*) bucketTriangleData.data(), bucketTriangleData.size() * sizeof(PAGED_TRIANGLE))) {
+			return IO_ERROR;
+		}
+
+		bucketInput.close();
+		std::sort(bucketTriangleData.begin(), bucketTriangleData.end(), [](const PAGED_TRIANGLE& first, const PAGED_TRIANGLE& second) {
+			return first.cell < second.cell;
+		});
+
+		for (size_t begin = 0, end = 0; begin < bucketTriangleData.size(); begin = end)
+		{
+			for (end = begin; end < bucketTriangleData.size() && bucketTriangleData[end].cell == bucketTriangleData[begin].cell; end++);
+
+			if (chunk == chunkCount) {
+				return FAILURE;
+			}
+
+			PAGED_CHUNK_ENTRY& entry = directory[chunk++];
+			glm::vec3 chunkMin(FLT_MAX, FLT_MAX, FLT_MAX);
+			glm::vec3 chunkMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+			chunkVertices.clear();
+			chunkIndices.clear();
+			localIndices.clear();
+
+			for (size_t i = begin; i < end; i++) {
+				for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+					uint32_t vertex = bucketTriangleData[i].vertexIndices[corner];
+					std::pair<std::unordered_map<uint32_t, uint32_t>::iterator, bool> inserted = localIndices.insert(std::make_pair(vertex, (uint32_t) chunkVertices.size()));
+
+					if (inserted.second) {
+						glm::vec3 position = MeshGeometry::NormalizeVertex(rawVertices[vertex], rawCentroid, absoluteMin, absoluteMax);
+						chunkVertices.push_back(position);
+						chunkMin = glm::min(chunkMin, position);
+						chunkMax = glm::max(chunkMax, position);
+					}
+
+					chunkIndices.push_back(inserted.first->second);
+				}
+			}
+
+			entry.offset = (uint64_t) output.tellp();
+			entry.vertexCount = (uint32_t) chunkVertices.size();
+			entry.indexCount = (uint32_t) chunkIndices.size();
+
+			for (int i = 0; i < 3; i++) {
+				entry.minCoordinates[i] = chunkMin[i];
+				entry.maxCoordinates[i] = chunkMax[i];
+			}
+
+			output.write((const char*) chunkVertices.data(), chunkVertices.size() * sizeof(glm::vec3));
+			output.write((const char*) chunkIndices.data(), chunkIndices.size() * sizeof(uint32_t));
+			chunkVertexCount += chunkVertices.size();
+		}
+
+		if (progress != nullptr) {
+			if (progress->cancelled) {
+				return FAILURE;
+			}
+
+			progress->fraction = 0.8f + 0.2f * (float) (bucket + 1) / (float) bucketPaths.size();
+		}
+	}
+
+	if (chunk != chunkCount) {
+		return FAILURE;
+	}
+
+	header.vertexCount = chunkVertexCount;
+	output.seekp(0);
+	output.write((const char*) &header, sizeof(header));
+	output.seekp(directoryOffset);
+	output.write((const char*) directory.data(), directory.size() * sizeof(PAGED_CHUNK_ENTRY));
+	output.close();
+
+	if (output.fail() || !MoveFileExA(temporaryPath.c_str(), pagePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		return IO_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+std::shared_ptr<PagedMesh> PagedMesh::Open(const std::string& sourcePath, uint64_t byteBudget)
+{
+	PAGED_MESH_HEADER expected;
+	PAGED_MESH_HEADER header;
+	std::shared_ptr<PagedMesh> mesh(new PagedMesh());
+
+	if (!FillHeader(sourcePath, expected)) {
+		return nullptr;
+	}
+
+	mesh->file.open(GetPagePath(sourcePath).c_str(), std::ios::binary);
+	mesh->file.seekg(0, std::ios::end);
+	uint64_t fileSize = (uint64_t) mesh->file.tellg();
+	mesh->file.seekg(0, std::ios::beg);
+
+	std::string storedPath(sourcePath.size(), '\0');
+	mesh->file.read((char*) &header, sizeof(header));
+
+	if (mesh->file.fail() ||
+		memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+		header.version != expected.version ||
+		header.sourceSize != expected.sourceSize ||
+		header.sourceModifiedTime != expected.sourceModifiedTime ||
+		header.sourcePathLength != expected.sourcePathLength ||
+		!mesh->file.read(&storedPath[0], storedPath.size()) ||
+		storedPath != sourcePath)
+	{
+		return nullptr;
+	}
+
+	std::vector<PAGED_CHUNK_ENTRY> directory(header.chunkCount);
+	uint64_t dataOffset = sizeof(header) + ALIGN4(sourcePath.size()) + directory.size() * sizeof(PAGED_CHUNK_ENTRY);
+
+	mesh->file.seekg(sizeof(header) + ALIGN4(sourcePath.size()));
+
+	if (dataOffset > fileSize || !mesh->file.read((char*) directory.data(), directory.size() * sizeof(PAGED_CHUNK_ENTRY))) {
+		return nullptr;
+	}
+
+	mesh->chunks.resize(directory.size());
+
+	for (size_t i = 0; i < directory.size(); i++) {
+		if (directory[i].offset < dataOffset || directory[i].offset > fileSize || GetChunkBytes(directory[i]) > fileSize - directory[i].offset) {
+			return nullptr;
+		}
+
+		mesh->chunks[i].entry = directory[i];
+		mesh->chunks[i].resident = false;
+		mesh->chunks[i].loading = false;
+		mesh->chunks[i].lastUsedFrame = 0;
+	}
+
+	mesh->faceCount = header.faceCount;
+	mesh->byteBudget = byteBudget;
+	mesh->centroid = glm::vec3(header.centroid[0], header.centroid[1], header.centroid[2]);
+	mesh->minCoordinates = glm::vec3(header.minCoordinates[0], header.minCoordinates[1], header.minCoordinates[2]);
+	mesh->maxCoordinates = glm::vec3(header.maxCoordinates[0], header.maxCoordinates[1], header.maxCoordinates[2]);
+
+	return mesh;
+}
+
+bool PagedMesh::IsOutsideViewVolume(const glm::mat4x4& transformation, const float minCoordinates[3], const float maxCoordinates[3])
+{
+	// Count, per side of the view volume, the corners beyond it. Depth is not clipped by the renderer, so it is not tested either.
+	int behind = 0;
+	int outside[4] = { 0, 0, 0, 0 };
+
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec4 point = transformation * glm::vec4(
+			(corner & 1) ? maxCoordinates[0] : minCoordinates[0],
+			(corner & 2) ? maxCoordinates[1] : minCoordinates[1],
+			(corner & 4) ? maxCoordinates[2] : minCoordinates[2],
+			1.0f);
+
+		behind += point.w <= 0 ? 1 : 0;
+		outside[0] += point.x < -point.w ? 1 : 0;
+		outside[1] += point.x > point.w ? 1 : 0;
+		outside[2] += point.y < -point.w ? 1 : 0;
+		outside[3] += point.y > point.w ? 1 : 0;
+	}
+
+	return behind == 8 || outside[0] == 8 || outside[1] == 8 || outside[2] == 8 || outside[3] == 8;
+}
+
+void PagedMesh::LoaderLoop()
+{
+	while (true)
+	{
+		PAGED_CHUNK_LOAD load;
+
+		{
+			std::unique_lock<std::mutex> lock(loadMutex);
+			loadCondition.wait(lock, [this]() { return stopping || !requestedChunks.empty(); });
+
+			if (stopping) {
+				return;
+			}
+
+			load.chunkIndex = requestedChunks.front();
+			requestedChunks.pop_front();
+		}
+
+		load.result = ReadChunk(load);
+
+		std::lock_guard<std::mutex> lock(loadMutex);
+		loadedChunks.push_back(std::move(load));
+	}
+}
+
+RETURN_VALUE PagedMesh::ReadChunk(PAGED_CHUNK_LOAD& load)
+{
+	// The entries never change after Open(), so they may be read while the render thread uses the chunks
+	const PAGED_CHUNK_ENTRY& entry = chunks[load.chunkIndex].entry;
+
+	load.vertices.resize(entry.vertexCount);
+	load.indices.resize(entry.indexCount);
+
+	file.seekg(entry.offset);
+	file.read((char*) load.vertices.data(), load.vertices.size() * sizeof(glm::vec3));
+	file.read((char*) load.indices.data(), load.indices.size() * sizeof(uint32_t));
+
+	bool isValid = !file.fail();
+
+	for (size_t i = 0; isValid && i < load.indices.size(); i++) {
+		isValid = load.indices[i] < entry.vertexCount;
+	}
+
+	if (!isValid) {
+		file.clear();
+		return IO_ERROR;
+	}
+
+	// Wireframes draw every edge of the chunk once, like the edge buffer of a whole geometry
+	MeshGeometry::BuildEdges(load.vertices, load.indices, load.edges);
+
+	return SUCCESS;
+}
+
+void PagedMesh::InstallLoadedChunks()
+{
+	std::vector<PAGED_CHUNK_LOAD> loads;
+
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		loads.swap(loadedChunks);
+	}
+
+	for each (PAGED_CHUNK_LOAD& load in loads)
+	{
+		PAGED_CHUNK& chunk = chunks[load.chunkIndex];
+		chunk.loading = false;
+
+		if (load.result != SUCCESS || chunk.resident || !MakeRoom(GetResidentChunkBytes(chunk.entry))) {
+			continue;
+		}
+
+		chunk.vertices.swap(load.vertices);
+		chunk.indices.swap(load.indices);
+		chunk.edges.swap(load.edges);
+		chunk.resident = true;
+		recentlyUsed.push_front(load.chunkIndex);
+		chunk.recentlyUsed = recentlyUsed.begin();
+		residentBytes += GetResidentChunkBytes(chunk.entry);
+	}
+}
+
+bool PagedMesh::MakeRoom(uint64_t chunkBytes)
+{
+	while (residentBytes + chunkBytes > byteBudget)
+	{
+		// Chunks seen in the current frame stay, even when they alone exceed the budget
+		if (recentlyUsed.empty() || chunks[recentlyUsed.back()].lastUsedFrame == frame) {
+			return false;
+		}
+
+		PAGED_CHUNK& chunk = chunks[recentlyUsed.back()];
+
+		std::vector<glm::vec3>().swap(chunk.vertices);
+		std::vector<uint32_t>().swap(chunk.indices);
+		std::vector<uint32_t>().swap(chunk.edges);
+		chunk.resident = false;
+		residentBytes -= GetResidentChunkBytes(chunk.entry);
+		recentlyUsed.pop_back();
+	}
+
+	return true;
+}
+
+void PagedMesh::UpdateResidency(const glm::mat4x4& transformation)
+{
+	std::vector<std::pair<float, size_t>> missingChunks;
+
+	frame++;
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		PAGED_CHUNK& chunk = chunks[i];
+
+		if (IsOutsideViewVolume(transformation, chunk.entry.minCoordinates, chunk.entry.maxCoordinates)) {
+			continue;
+		}
+
+		chunk.lastUsedFrame = frame;
+
+		if (chunk.resident) {
+			recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, chunk.recentlyUsed);
+		}
+		else {
+			glm::vec4 center = transformation * glm::vec4(
+				(chunk.entry.minCoordinates[0] + chunk.entry.maxCoordinates[0]) / 2,
+				(chunk.entry.minCoordinates[1] + chunk.entry.maxCoordinates[1]) / 2,
+				(chunk.entry.minCoordinates[2] + chunk.entry.maxCoordinates[2]) / 2,
+				1.0f);
+
+			missingChunks.push_back(std::make_pair(center.w, i));
+		}
+	}
+
+	InstallLoadedChunks();
+
+	// Requests of earlier frames which were not started yet are replaced by the ones of this frame
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+
+		for each (size_t chunkIndex in requestedChunks) {
+			chunks[chunkIndex].loading = false;
+		}
+
+		requestedChunks.clear();
+	}
+
+	// What may still be read: the budget, less what stays resident for this frame and what is being read already
+	uint64_t claimedBytes = 0;
+
+	for each (const PAGED_CHUNK& chunk in chunks) {
+		if ((chunk.resident && chunk.lastUsedFrame == frame) || chunk.loading) {
+			claimedBytes += GetResidentChunkBytes(chunk.entry);
+		}
+	}
+
+	// When the budget cannot hold everything in view, the chunks closest to the eye are read first
+	std::sort(missingChunks.begin(), missingChunks.end());
+	std::deque<size_t> requests;
+
+	for each (auto missingChunk in missingChunks)
+	{
+		PAGED_CHUNK& chunk = chunks[missingChunk.second];
+		uint64_t chunkBytes = GetResidentChunkBytes(chunk.entry);
+
+		if (chunk.resident || chunk.loading) {
+			continue;
+		}
+
+		if (claimedBytes + chunkBytes > byteBudget) {
+			break;
+		}
+
+		claimedBytes += chunkBytes;
+		chunk.loading = true;
+		requests.push_back(missingChunk.second);
+	}
+
+	if (!requests.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(loadMutex);
+			requestedChunks.swap(requests);
+		}
+
+		// The loading thread is only started once something has to be read
+		if (!loader.joinable()) {
+			loader = std::thread(&PagedMesh::LoaderLoop, this);
+		}
+
+		loadCondition.notify_one();
+	}
+
+	// A lowered budget is applied even when nothing new came into view
+	MakeRoom(0);
+}
@@ -0,0 +1,495 @@
+#include "PlyParser.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#define PLY_PROGRESS_STEP					65536
+#define PLY_MAX_TYPE_SIZE					8
+
+static const size_t PLY_TYPE_SIZES[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+static const std::pair<const char*, PLY_TYPE> PLY_TYPE_NAMES[] = {
+	{ "char", PLY_INT8 },		{ "int8", PLY_INT8 },
+	{ "uchar", PLY_UINT8 },		{ "uint8", PLY_UINT8 },
+	{ "short", PLY_INT16 },		{ "int16", PLY_INT16 },
+	{ "ushort", PLY_UINT16 },	{ "uint16", PLY_UINT16 },
+	{ "int", PLY_INT32 },		{ "int32", PLY_INT32 },
+	{ "uint", PLY_UINT32 },		{ "uint32", PLY_UINT32 },
+	{ "float", PLY_FLOAT32 },	{ "float32", PLY_FLOAT32 },
+	{ "double", PLY_FLOAT64 },	{ "float64", PLY_FLOAT64 }
+};
+
+static PLY_TYPE ToPlyType(const std::string& name)
+{
+	for (const auto& typeName : PLY_TYPE_NAMES) {
+		if (name == typeName.first) {
+			return typeName.second;
+		}
+	}
+
+	return PLY_INVALID;
+}
+
+static bool IsHostBigEndian()
+{
+	const uint16_t probe = 1;
+	return *(const uint8_t*) &probe == 0;
+}
+
+static double ReadValue(const char* cursor, PLY_TYPE type, bool swapBytes)
+{
+	uint8_t bytes[PLY_MAX_TYPE_SIZE];
+	size_t size = PLY_TYPE_SIZES[type];
+
+	memcpy(bytes, cursor, size);
+
+	if (swapBytes) {
+		for (size_t i = 0; i < size / 2; i++) {
+			uint8_t byte = bytes[i];
+			bytes[i] = bytes[size - 1 - i];
+			bytes[size - 1 - i] = byte;
+		}
+	}
+
+	switch (type)
+	{
+		case PLY_INT8:		{ int8_t value;		memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_UINT8:		{ uint8_t value;	memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_INT16:		{ int16_t value;	memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_UINT16:	{ uint16_t value;	memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_INT32:		{ int32_t value;	memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_UINT32:	{ uint32_t value;	memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_FLOAT32:	{ float value;		memcpy(&value, bytes, sizeof(value)); return value; }
+		case PLY_FLOAT64:	{ double value;		memcpy(&value, bytes, sizeof(value)); return value; }
+		default:			return 0;
+	}
+}
+
+// Skips a list property, returns nullptr when the record runs past the end of the data
+static const char* SkipList(const char* cursor, const char* end, const PLY_PROPERTY& property, bool swapBytes)
+{
+	size_t countSize = PLY_TYPE_SIZES[property.countType];
+
+	if ((size_t) (end - cursor) < countSize) {
+		return nullptr;
+	}
+
+	double count = ReadValue(cursor, property.countType, swapBytes);
+	cursor += countSize;
+
+	if (count < 0 || (end - cursor) / PLY_TYPE_SIZES[property.type] < count) {
+		return nullptr;
+	}
+
+	return cursor + (size_t) count * PLY_TYPE_SIZES[property.type];
+}
+
+// Finds a float32 triplet stored as three consecutive properties, which may then be copied as a single vec3
+static bool FindFloatTriplet(const PLY_ELEMENT& element, const char* x, const char* y, const char* z, int& first)
+{
+	for (size_t i = 0; i + 2 < element.properties.size(); i++)
+	{
+		const PLY_PROPERTY* properties = &element.properties[i];
+
+		if (properties[0].name == x && properties[1].name == y && properties[2].name == z)
+		{
+			first = (int) i;
+			return !properties[0].isList && !properties[1].isList && !properties[2].isList &&
+				properties[0].type == PLY_FLOAT32 && properties[1].type == PLY_FLOAT32 && properties[2].type == PLY_FLOAT32;
+		}
+	}
+
+	first = DISABLED;
+	return false;
+}
+
+// Every record takes at least its scalars and the counts of its lists. Checked before allocating for the records,
+// so a count the data cannot hold fails the load instead of the allocation.
+static bool HasRoomFor(const char* cursor, const char* end, const PLY_ELEMENT& element)
+{
+	size_t minRecordSize = 0;
+
+	for each (const PLY_PROPERTY& property in element.properties) {
+		minRecordSize += PLY_TYPE_SIZES[property.isList ? property.countType : property.type];
+	}
+
+	return minRecordSize > 0 && (size_t) (end - cursor) / minRecordSize >= element.count;
+}
+
+static int FindProperty(const PLY_ELEMENT& element, const char* name)
+{
+	for (size_t i = 0; i < element.properties.size(); i++) {
+		if (element.properties[i].name == name) {
+			return (int) i;
+		}
+	}
+
+	return DISABLED;
+}
+
+RETURN_VALUE PlyParser::ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	MappedFile file;
+
+	if (file.Open(filePath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	return Parse(file.GetData(), file.GetEnd(), meshData, progress);
+}
+
+RETURN_VALUE PlyParser::ParseHeader(const char*& cursor, const char* end, std::vector<PLY_ELEMENT>& elements, bool& isBigEndian)
+{
+	bool isFirstLine = true;
+	bool hasFormat = false;
+
+	while (cursor < end)
+	{
+		const char* newLine = (const char*) memchr(cursor, '\n', end - cursor);
+
+		if (!newLine) {
+			return FAILURE;
+		}
+
+		std::istringstream issLine(std::string(cursor, newLine));
+		std::string lineType;
+		cursor = newLine + 1;
+
+		issLine >> lineType;
+
+		if (isFirstLine)
+		{
+			if (lineType != "ply") {
+				return FAILURE;
+			}
+
+			isFirstLine = false;
+		}
+		else if (lineType == "format")
+		{
+			std::string format;
+			issLine >> format;
+
+			if (format != "binary_little_endian" && format != "binary_big_endian") {
+				fprintf(stderr, "Only binary .ply files are supported\n");
+				return FAILURE;
+			}
+
+			isBigEndian = format == "binary_big_endian";
+			hasFormat = true;
+		}
+		else if (lineType == "element")
+		{
+			PLY_ELEMENT element;
+			issLine >> element.name >> element.count;
+
+			if (issLine.fail()) {
+				return FAILURE;
+			}
+
+			element.stride = 0;
+			element.hasLists = false;
+			elements.push_back(element);
+		}
+		else if (lineType == "property")
+		{
+			PLY_PROPERTY property;
+			std::string typeName;
+
+			if (elements.empty()) {
+				return FAILURE;
+			}
+
+			PLY_ELEMENT& element = elements.back();
+			issLine >> typeName;
+			property.isList = typeName == "list";
+			property.countType = PLY_INVALID;
+
+			if (property.isList) {
+				issLine >> typeName;
+				property.countType = ToPlyType(typeName);
+				issLine >> typeName;
+			}
+
+			issLine >> property.name;
+			property.type = ToPlyType(typeName);
+			property.offset = element.stride;
+
+			if (issLine.fail() || property.type == PLY_INVALID || (property.isList && property.countType == PLY_INVALID)) {
+				return FAILURE;
+			}
+
+			if (property.isList) {
+				element.hasLists = true;
+			}
+			else {
+				element.stride += PLY_TYPE_SIZES[property.type];
+			}
+
+			element.properties.push_back(property);
+		}
+		else if (lineType == "end_header")
+		{
+			return hasFormat ? SUCCESS : FAILURE;
+		}
+	}
+
+	return FAILURE;
+}
+
+const char* PlyParser::SkipElement(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes)
+{
+	if (!element.hasLists)
+	{
+		if (element.stride > 0 && (size_t) (end - cursor) / element.stride < element.count) {
+			return nullptr;
+		}
+
+		return cursor + element.count * element.stride;
+	}
+
+	for (size_t record = 0; record < element.count; record++) {
+		for (size_t i = 0; cursor && i < element.properties.size(); i++)
+		{
+			const PLY_PROPERTY& property = element.properties[i];
+
+			if (property.isList) {
+				cursor = SkipList(cursor, end, property, swapBytes);
+			}
+			else if ((size_t) (end - cursor) < PLY_TYPE_SIZES[property.type]) {
+				return nullptr;
+			}
+			else {
+				cursor += PLY_TYPE_SIZES[property.type];
+			}
+		}
+
+		if (!cursor) {
+			return nullptr;
+		}
+	}
+
+	return cursor;
+}
+
+const char* PlyParser::ReadVertices(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes, MESH_DATA& meshData)
+{
+	int position, normal;
+	bool isPositionPacked = FindFloatTriplet(element, "x", "y", "z", position);
+	bool isNormalPacked = FindFloatTriplet(element, "nx", "ny", "nz", normal);
+
+	if (position == DISABLED) {
+		return nullptr;
+	}
+
+	if (!HasRoomFor(cursor, end, element)) {
+		return nullptr;
+	}
+
+	meshData.vertices.resize(element.count);
+
+	if (normal != DISABLED) {
+		meshData.normals.resize(element.count);
+	}
+
+	// Records of the native byte order with packed coordinates are copied as they are
+	if (!swapBytes && !element.hasLists && isPositionPacked && (normal == DISABLED || isNormalPacked))
+	{
+		size_t positionOffset = element.properties[position].offset;
+
+		if (element.stride == sizeof(glm::vec3)) {
+			memcpy(meshData.vertices.data(), cursor, element.count * sizeof(glm::vec3));
+			return cursor + element.count * element.stride;
+		}
+
+		for (size_t i = 0; i < element.count; i++, cursor += element.stride)
+		{
+			memcpy(&meshData.vertices[i], cursor + positionOffset, sizeof(glm::vec3));
+
+			if (normal != DISABLED) {
+				memcpy(&meshData.normals[i], cursor + element.properties[normal].offset, sizeof(glm::vec3));
+			}
+		}
+
+		return cursor;
+	}
+
+	std::vector<double> values(element.properties.size());
+
+	for (size_t i = 0; i < element.count; i++)
+	{
+		for (size_t j = 0; j < element.properties.size(); j++)
+		{
+			const PLY_PROPERTY& property = element.properties[j];
+
+			if (property.isList) {
+				cursor = SkipList(cursor, end, property, swapBytes);
+
+				if (!cursor) {
+					return nullptr;
+				}
+
+				continue;
+			}
+
+			if ((size_t) (end - cursor) < PLY_TYPE_SIZES[property.type]) {
+				return nullptr;
+			}
+
+			values[j] = ReadValue(cursor, property.type, swapBytes);
+			cursor += PLY_TYPE_SIZES[property.type];
+		}
+
+		meshData.vertices[i] = glm::vec3(values[position], values[position + 1], values[position + 2]);
+
+		if (normal != DISABLED) {
+			meshData.normals[i] = glm::vec3(values[normal], values[normal + 1], values[normal + 2]);
+		}
+	}
+
+	return cursor;
+}
+
+const char* PlyParser::ReadFaces(const char* cursor, const char* end, const PLY_ELEMENT& element, bool swapBytes, MESH_DATA& meshData, PLOAD_PROGRESS progress, const char* begin)
+{
+	int indicesProperty = FindProperty(element, "vertex_indices");
+
+	if (indicesProperty == DISABLED) {
+		indicesProperty = FindProperty(element, "vertex_index");
+	}
+
+	if (indicesProperty == DISABLED || !element.properties[indicesProperty].isList) {
+		return nullptr;
+	}
+
+	const PLY_PROPERTY& indices = element.properties[indicesProperty];
+	const size_t countSize = PLY_TYPE_SIZES[indices.countType];
+	const size_t indexSize = PLY_TYPE_SIZES[indices.type];
+	// The common "list uchar int" layout with nothing else in the record is copied a triangle at a time
+	const bool isPacked = !swapBytes && element.properties.size() == 1 && indices.countType == PLY_UINT8 &&
+		(indices.type == PLY_INT32 || indices.type == PLY_UINT32);
+	std::vector<int> polygon;
+
+	if (!HasRoomFor(cursor, end, element)) {
+		return nullptr;
+	}
+
+	meshData.vertexIndices.reserve(meshData.vertexIndices.size() + element.count * FACE_ELEMENTS);
+
+	for (size_t face = 0; face < element.count; face++)
+	{
+		if (progress && face % PLY_PROGRESS_STEP == 0)
+		{
+			progress->fraction = (float) (cursor - begin) / (end - begin);
+
+			if (progress->cancelled) {
+				return nullptr;
+			}
+		}
+
+		if (isPacked && end - cursor >= 1 + FACE_ELEMENTS * (ptrdiff_t) sizeof(int32_t) && (uint8_t) *cursor == FACE_ELEMENTS)
+		{
+			size_t size = meshData.vertexIndices.size();
+			meshData.vertexIndices.resize(size + FACE_ELEMENTS);
+			memcpy(&meshData.vertexIndices[size], cursor + 1, FACE_ELEMENTS * sizeof(int32_t));
+			cursor += 1 + FACE_ELEMENTS * sizeof(int32_t);
+			continue;
+		}
+
+		for (size_t i = 0; i < element.properties.size(); i++)
+		{
+			const PLY_PROPERTY& property = element.properties[i];
+
+			if ((int) i != indicesProperty)
+			{
+				if (property.isList) {
+					cursor = SkipList(cursor, end, property, swapBytes);
+				}
+				else if ((size_t) (end - cursor) < PLY_TYPE_SIZES[property.type]) {
+					cursor = nullptr;
+				}
+				else {
+					cursor += PLY_TYPE_SIZES[property.type];
+				}
+
+				if (!cursor) {
+					return nullptr;
+				}
+
+				continue;
+			}
+
+			if ((size_t) (end - cursor) < countSize) {
+				return nullptr;
+			}
+
+			double count = ReadValue(cursor, indices.countType, swapBytes);
+			cursor += countSize;
+
+			if (count < 0 || (end - cursor) / indexSize < count) {
+				return nullptr;
+			}
+
+			polygon.resize((size_t) count);
+
+			for (size_t j = 0; j < polygon.size(); j++, cursor += indexSize) {
+				polygon[j] = (int) ReadValue(cursor, indices.type, swapBytes);
+			}
+
+			// Split the polygon into a fan of triangles around its first corner
+			for (size_t j = 1; j + 1 < polygon.size(); j++) {
+				meshData.vertexIndices.push_back(polygon[0]);
+				meshData.vertexIndices.push_back(polygon[j]);
+				meshData.vertexIndices.push_back(polygon[j + 1]);
+			}
+		}
+	}
+
+	return cursor;
+}
+
+RETURN_VALUE PlyParser::Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	std::vector<PLY_ELEMENT> elements;
+	bool isBigEndian = false;
+	const char* cursor = begin;
+
+	if (ParseHeader(cursor, end, elements, isBigEndian) != SUCCESS) {
+		return FAILURE;
+	}
+
+	bool swapBytes = isBigEndian != IsHostBigEndian();
+
+	for (const PLY_ELEMENT& element : elements)
+	{
+		if (element.name == "vertex") {
+			cursor = ReadVertices(cursor, end, element, swapBytes, meshData);
+		}
+		else if (element.name == "face") {
+			cursor = ReadFaces(cursor, end, element, swapBytes, meshData, progress, begin);
+		}
+		else {
+			cursor = SkipElement(cursor, end, element, swapBytes);
+		}
+
+		if (!cursor) {
+			return FAILURE;
+		}
+	}
+
+	// Unlike .obj indices, the binary ones are taken as they are, so they have to be checked once
+	for each (int index in meshData.vertexIndices) {
+		if (index < 0 || (size_t) index >= meshData.vertices.size()) {
+			return FAILURE;
+		}
+	}
+
+	// Vertex normals belong to the vertex with the same index
+	if (!meshData.normals.empty()) {
+		meshData.normalIndices = meshData.vertexIndices;
+	}
+
+	return SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "PrimitiveGenerator.h"
+#include <cstdint>
+#include <unordered_map>
+
+#define GOLDEN_RATIO						1.6180339887498948f
+
+std::mutex PrimitiveGenerator::generatorMutex;
+std::map<std::pair<PRIMITIVE, unsigned int>, std::shared_ptr<const MeshGeometry>> PrimitiveGenerator::geometries;
+
+// Unit cube, the triangles are wound counter clockwise when seen from outside
+static constexpr float CUBE_VERTICES[][3] = {
+	{ -1, -1, -1 }, { -1, -1,  1 }, {  1, -1,  1 }, {  1, -1, -1 },
+	{ -1,  1, -1 }, { -1,  1,  1 }, {  1,  1,  1 }, {  1,  1, -1 }
+};
+
+static constexpr int CUBE_INDICES[] = {
+	0, 2, 1,	0, 3, 2,	// Bottom
+	4, 5, 6,	4, 6, 7,	// Top
+	1, 2, 6,	1, 6, 5,	// Near
+	0, 7, 3,	0, 4, 7,	// Far
+	3, 7, 6,	3, 6, 2,	// Right
+	0, 1, 5,	0, 5, 4		// Left
+};
+
+static constexpr float ICOSAHEDRON_VERTICES[][3] = {
+	{ -1,  GOLDEN_RATIO, 0 }, {  1,  GOLDEN_RATIO, 0 }, { -1, -GOLDEN_RATIO, 0 }, {  1, -GOLDEN_RATIO, 0 },
+	{ 0, -1,  GOLDEN_RATIO }, { 0,  1,  GOLDEN_RATIO }, { 0, -1, -GOLDEN_RATIO }, { 0,  1, -GOLDEN_RATIO },
+	{  GOLDEN_RATIO, 0, -1 }, {  GOLDEN_RATIO, 0,  1 }, { -GOLDEN_RATIO, 0, -1 }, { -GOLDEN_RATIO, 0,  1 }
+};
+
+static constexpr int ICOSAHEDRON_INDICES[] = {
+	0, 11, 5,	0, 5, 1,	0, 1, 7,	0, 7, 10,	0, 10, 11,
+	1, 5, 9,	5, 11, 4,	11, 10, 2,	10, 7, 6,	7, 1, 8,
+	3, 9, 4,	3, 4, 2,	3, 2, 6,	3, 6, 8,	3, 8, 9,
+	4, 9, 5,	2, 4, 11,	6, 2, 10,	8, 6, 7,	9, 8, 1
+};
+
+// Camera body with the lens frustum opening towards -z and a marker on top showing its up direction
+static constexpr float CAMERA_VERTICES[][3] = {
+	{ -0.6f, -0.5f, 0.0f }, { -0.6f, -0.5f, 1.6f }, {  0.6f, -0.5f, 1.6f }, {  0.6f, -0.5f, 0.0f },
+	{ -0.6f,  0.5f, 0.0f }, { -0.6f,  0.5f, 1.6f }, {  0.6f,  0.5f, 1.6f }, {  0.6f,  0.5f, 0.0f },
+	{ -0.3f, -0.25f, 0.0f }, {  0.3f, -0.25f, 0.0f }, {  0.3f,  0.25f, 0.0f }, { -0.3f,  0.25f, 0.0f },
+	{ -0.6f, -0.5f, -0.9f }, {  0.6f, -0.5f, -0.9f }, {  0.6f,  0.5f, -0.9f }, { -0.6f,  0.5f, -0.9f },
+	{ -0.25f, 0.5f, 0.8f }, {  0.25f, 0.5f, 0.8f }, {  0.0f, 0.85f, 0.8f }
+};
+
+static constexpr int CAMERA_INDICES[] = {
+	0, 2, 1,	0, 3, 2,	4, 5, 6,	4, 6, 7,	1, 2, 6,	1, 6, 5,		// Body
+	0, 7, 3,	0, 4, 7,	3, 7, 6,	3, 6, 2,	0, 1, 5,	0, 5, 4,
+	8, 13, 9,	8, 12, 13,	9, 14, 10,	9, 13, 14,	10, 15, 11,	10, 14, 15,		// Lens
+	11, 12, 8,	11, 15, 12,	12, 14, 13,	12, 15, 14,
+	16, 17, 18																// Up marker
+};
+
+template <size_t VERTEX_COUNT, size_t INDEX_COUNT>
+static void CopyTables(const float (&vertices)[VERTEX_COUNT][3], const int (&indices)[INDEX_COUNT], MESH_DATA& meshData)
+{
+	meshData.vertices.reserve(VERTEX_COUNT);
+
+	for (size_t i = 0; i < VERTEX_COUNT; i++) {
+		meshData.vertices.push_back(glm::vec3(vertices[i][0], vertices[i][1], vertices[i][2]));
+	}
+
+	meshData.vertexIndices.assign(indices, indices + INDEX_COUNT);
+}
+
+void PrimitiveGenerator::BuildCube(MESH_DATA& meshData)
+{
+	CopyTables(CUBE_VERTICES, CUBE_INDICES, meshData);
+}
+
+void PrimitiveGenerator::BuildCamera(MESH_DATA& meshData)
+{
+	CopyTables(CAMERA_VERTICES, CAMERA_INDICES, meshData);
+}
+
+void PrimitiveGenerator::BuildSphere(MESH_DATA& meshData, unsigned int tessellationLevel)
+{
+	std::vector<glm::vec3>& vertices = meshData.vertices;
+	std::vector<int>& indices = meshData.vertexIndices;
+
+	CopyTables(ICOSAHEDRON_VERTICES, ICOSAHEDRON_INDICES, meshData);
+
+	for (auto& vertex : vertices) {
+		vertex = glm::normalize(vertex);
+	}
+
+	// Split every triangle into four, the edge midpoints are shared between the two triangles of an edge
+	for (unsigned int level = 0; level < tessellationLevel; level++)
+	{
+		std::unordered_map<uint64_t, int> midpoints;
+		std::vector<int> subdividedIndices;
+		subdividedIndices.reserve(indices.size() * 4);
+
+		auto midpoint = [&](int a, int b) -> int {
+			uint64_t key = a < b ? ((uint64_t) a << 32) | (uint32_t) b : ((uint64_t) b << 32) | (uint32_t) a;
+			auto found = midpoints.find(key);
+
+			if (found != midpoints.end()) {
+				return found->second;
+			}
+
+			vertices.push_back(glm::normalize(vertices[a] + vertices[b]));
+			midpoints[key] = (int) vertices.size() - 1;
+
+			return (int) vertices.size() - 1;
+		};
+
+		for (size_t i = 0; i + FACE_ELEMENTS <= indices.size(); i += FACE_ELEMENTS) {
+			int v1 = indices[i];
+			int v2 = indices[i + 1];
+			int v3 = indices[i + 2];
+			int m12 = midpoint(v1, v2);
+			int m23 = midpoint(v2, v3);
+			int m31 = midpoint(v3, v1);
+
+			int triangles[] = { v1, m12, m31,	v2, m23, m12,	v3, m31, m23,	m12, m23, m31 };
+			subdividedIndices.insert(subdividedIndices.end(), triangles, triangles + 12);
+		}
+
+		indices.swap(subdividedIndices);
+	}
+
+	// On a unit sphere a vertex is its own normal
+	meshData.normals = vertices;
+	meshData.normalIndices = indices;
+}
+
+void PrimitiveGenerator::Build(PRIMITIVE primitive, MESH_DATA& meshData, unsigned int tessellationLevel)
+{
+	switch (primitive)
+	{
+		case SPHERE:
+			BuildSphere(meshData, tessellationLevel < SPHERE_MAX_TESSELLATION ? tessellationLevel : SPHERE_MAX_TESSELLATION);
+			break;
+		case CUBE:
+			BuildCube(meshData);
+			break;
+		case CAMERA:
+			BuildCamera(meshData);
+			break;
+	}
+}
+
+std::shared_ptr<const MeshGeometry> PrimitiveGenerator::GetGeometry(PRIMITIVE primitive, unsigned int tessellationLevel)
+{
+	// Only the sphere depends on the tessellation level
+	if (primitive != SPHERE) {
+		tessellationLevel = 0;
+	}
+	else if (tessellationLevel > SPHERE_MAX_TESSELLATION) {
+		tessellationLevel = SPHERE_MAX_TESSELLATION;
+	}
+
+	std::lock_guard<std::mutex> lock(generatorMutex);
+	std::shared_ptr<const MeshGeometry>& geometry = geometries[std::make_pair(primitive, tessellationLevel)];
+
+	if (!geometry) {
+		MESH_DATA meshData;
+		Build(primitive, meshData, tessellationLevel);
+		geometry = std::make_shared<MeshGeometry>(std::move(meshData));
+	}
+
+	return geometry;
+}
@@ -5,12 +5,38 @@
 #include "MeshModel.h"
 #include "Utils.h"
 #include "Constants.h"
+#include "TransformKernels.h"
 #include <imgui/imgui.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 #include <cmath>
+#include <Windows.h>
 
 #define INDEX(width, x, y, c) ((x) + (y) * (width)) * 3 + (c)
 #define IS_CAMERA true
+// Triangle corners are snapped to 1/16 of a pixel
+#define RASTER_SUBPIXEL_BITS				4
+#define RASTER_SUBPIXELS					(1 << RASTER_SUBPIXEL_BITS)
+// Triangles reaching further off screen are dropped, which keeps the fixed point edge functions far from overflowing
+#define RASTER_GUARD_BAND					1048576.0f
+// Light of faces seen edge on, facing the viewer gives full light
+#define RASTER_AMBIENT						0.2f
+// Side of the square screen tiles rasterized in parallel
+#define RASTER_TILE_SIZE					64
+// Binned primitives are rasterized once this many are waiting, which bounds the memory a frame takes
+#define RASTER_MAX_BINNED					(1 << 20)
+#define BENCHMARK_REPETITIONS				5
+
+// Written so that NaN fails as well
+static bool IsInGuardBand(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3)
+{
+	return fabs(p1.x) < RASTER_GUARD_BAND && fabs(p1.y) < RASTER_GUARD_BAND && fabs(p2.x) < RASTER_GUARD_BAND &&
+		fabs(p2.y) < RASTER_GUARD_BAND && fabs(p3.x) < RASTER_GUARD_BAND && fabs(p3.y) < RASTER_GUARD_BAND;
+}
 
 Renderer::Renderer(int viewportWidth, int viewportHeight, int viewportX, int viewportY) :
 	colorBuffer(nullptr),
@@ -19,7 +45,10 @@ Renderer::Renderer(int viewportWidth, int viewportHeight, int viewportX, int vie
 	cameraTransformation(I_MATRIX),
 	objectTranformation(I_MATRIX),
 	projection(I_MATRIX),
-	worldTranformation(I_MATRIX)
+	worldTranformation(I_MATRIX),
+	useTiles(false),
+	tileColumns(0),
+	tileRows(0)
 {
 	initOpenGLRendering();
 	SetViewport(viewportWidth, viewportHeight, viewportX, viewportY);
@@ -31,6 +60,11 @@ Renderer::~Renderer()
 	{
 		delete[] colorBuffer;
 	}
+
+	if (zBuffer)
+	{
+		delete[] zBuffer;
+	}
 }
 
 void Renderer::createBuffers(int viewportWidth, int viewportHeight)
@@ -40,7 +74,19 @@ void Renderer::createBuffers(int viewportWidth, int viewportHeight)
 		delete[] colorBuffer;
 	}
 
+	if (zBuffer)
+	{
+		delete[] zBuffer;
+	}
+
 	colorBuffer = new float[3* viewportWidth * viewportHeight];
+	zBuffer = new float[viewportWidth * viewportHeight];
+	ClearDepthBuffer();
+
+	tileColumns = (viewportWidth + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	tileRows = (viewportHeight + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	tileBins.assign(tileColumns * tileRows, std::vector<uint32_t>());
+
 	for (int x = 0; x < viewportWidth; x++)
 	{
 		for (int y = 0; y < viewportHeight; y++)
@@ -61,6 +107,11 @@ void Renderer::ClearColorBuffer(const glm::vec3& color)
 	}
 }
 
+void Renderer::ClearDepthBuffer()
+{
+	std::fill(zBuffer, zBuffer + viewportWidth * viewportHeight, FLT_MAX);
+}
+
 void Renderer::SetViewport(int viewportWidth, int viewportHeight, int viewportX, int viewportY)
 {
 	this->viewportX = viewportX;
@@ -72,6 +123,12 @@ void Renderer::SetViewport(int viewportWidth, int viewportHeight, int viewportX,
 }
 
 void Renderer::Render(Scene* scene)
+{
+	DrawScene(scene);
+	SwapBuffers();
+}
+
+void Renderer::DrawScene(Scene* scene)
 {
 	if (scene->GetActiveCameraIndex() != DISABLED) {
 		Camera* activeCamera = scene->GetActiveCamera();
@@ -79,30 +136,109 @@ void Renderer::Render(Scene* scene)
 		SetProjection(activeCamera->GetProjection());
 	}
 
+	if (scene->GetRenderMode() == RENDER_SOLID) {
+		ClearDepthBuffer();
+	}
+
+	useTiles = scene->ShouldUseTiledRasterizer() && workerPool.GetThreadCount() > 1;
+	cullingStats = CULLING_STATS();
+
 	DrawAxis(scene);
 
-	std::vector<std::shared_ptr<MeshModel>> models = scene->GetModels();
-	std::vector<Camera*> cameras = scene->GetCameras();
+	const std::vector<std::shared_ptr<MeshModel>>& models = scene->GetModels();
+	const std::vector<Camera*>& cameras = scene->GetCameras();
 
 	for each (auto model in models)
 	{
-		const std::pair<std::vector<glm::vec3>, std::pair<std::vector<glm::vec3>, std::vector<glm::vec3>>>* modelVertices;
+		std::shared_ptr<PagedMeshModel> pagedModel = std::dynamic_pointer_cast<PagedMeshModel>(model);
+
+		if (pagedModel) {
+			DrawPagedModel(scene, pagedModel.get());
+			continue;
+		}
+
+		std::shared_ptr<InstancedMeshModel> instancedModel = std::dynamic_pointer_cast<InstancedMeshModel>(model);
+
+		if (instancedModel) {
+			DrawInstancedModel(scene, instancedModel.get());
+			continue;
+		}
 
-		modelVertices = model->Render();
 		SetObjectMatrices(model->GetModelTransformation(), model->GetNormalTransformation());
 		SetWorldTransformation(scene->GetWorldTransformation());
 
-		DrawTriangles(scene, &modelVertices->first, scene->ShouldShowFacesNormals(), &model->GetCentroid(), 1);
+		glm::mat4x4 viewVolumeTransformation = GetViewVolumeTransformation(scene);
 
-		if (scene->ShouldShowVerticesNormals() && !modelVertices->second.second.empty()) {
-			DrawVerticesNormals(scene, modelVertices->second.first, modelVertices->second.second);
+		// Models out of view are skipped before their geometry is touched
+		if (IsOutsideView(viewVolumeTransformation, *model->GetGeometry())) {
+			cullingStats.culledModels++;
+			continue;
 		}
 
-		if (scene->ShouldShowBorderCube()) {
-			DrawBorderCube(scene, model->GetBorderCube());
+		cullingStats.visibleModels++;
+		MESH_VIEW modelView = model->Render();
+
+		// Models covering little of the screen are drawn from a simplified version of their geometry
+		std::shared_ptr<const MeshGeometry> drawnGeometry = model->GetGeometry();
+		size_t lodLevel = 0;
+
+		if (scene->ShouldUseLevelOfDetail() && model->GetLods()) {
+			drawnGeometry = model->GetLods()->Select(model->GetGeometry(), GetLodFaceBudget(scene, *model->GetGeometry()), lodLevel);
 		}
 
-		delete modelVertices;
+		model->SetLodLevel(lodLevel);
+		MESH_VIEW drawnView = drawnGeometry->GetView();
+		const VERTEX_STREAMS* vertexStreams = scene->ShouldUseVertexStreams() ? &drawnGeometry->GetPositionStreams() : NULL;
+		VOLUME_TEST volumeTest = VOLUME_INSIDE;
+
+		// Large meshes skip the parts of their hierarchy outside the view, partly visible ones draw only the faces left
+		if (drawnView.indices.size() / FACE_ELEMENTS >= BVH_MIN_FACES) {
+			visibleFaces.clear();
+			volumeTest = drawnGeometry->GetBvh().QueryFrustum(viewVolumeTransformation, visibleFaces);
+		}
+
+		if (volumeTest == VOLUME_PARTIAL) {
+			visibleIndices.resize(visibleFaces.size() * FACE_ELEMENTS);
+
+			for (size_t i = 0; i < visibleFaces.size(); i++) {
+				visibleIndices[i * 3] = drawnView.indices[visibleFaces[i] * 3];
+				visibleIndices[i * 3 + 1] = drawnView.indices[visibleFaces[i] * 3 + 1];
+				visibleIndices[i * 3 + 2] = drawnView.indices[visibleFaces[i] * 3 + 2];
+			}
+
+			// Wireframes keep the edges between corners of visible faces. An edge of a culled face between two such
+			// corners is kept too, it lies outside the view and is clipped.
+			visibleEdges.clear();
+
+			if (scene->GetRenderMode() == RENDER_WIREFRAME && !drawnView.edges.empty()) {
+				visibleEdgeVertices.assign(drawnView.vertices.size(), 0);
+
+				for (size_t i = 0; i < visibleIndices.size(); i++) {
+					visibleEdgeVertices[drawnView.edgeVertices[visibleIndices[i]]] = 1;
+				}
+
+				for (size_t i = 0; i + 1 < drawnView.edges.size(); i += 2) {
+					if (visibleEdgeVertices[drawnView.edges[i]] && visibleEdgeVertices[drawnView.edges[i + 1]]) {
+						visibleEdges.push_back(drawnView.edges[i]);
+						visibleEdges.push_back(drawnView.edges[i + 1]);
+					}
+				}
+			}
+
+			DrawTriangles(scene, drawnView.vertices, visibleIndices, scene->ShouldShowFacesNormals(), &model->GetCentroid(), 1, FALSE, vertexStreams, visibleEdges);
+		}
+		else if (volumeTest == VOLUME_INSIDE) {
+			DrawTriangles(scene, drawnView.vertices, drawnView.indices, scene->ShouldShowFacesNormals(), &model->GetCentroid(), 1, FALSE, vertexStreams, drawnView.edges);
+		}
+
+		if (scene->ShouldShowVerticesNormals() && !modelView.normals.empty()) {
+			DrawVerticesNormals(scene, modelView.vertices, modelView.normals);
+		}
+
+		// Models without triangles, like the first preview of a loading model, are shown by their bounds
+		if (scene->ShouldShowBorderCube() || modelView.indices.empty()) {
+			DrawBorderCube(scene, model->GetBorderCube());
+		}
 	}
 
 	for each(auto camera in cameras)
@@ -118,15 +254,47 @@ void Renderer::Render(Scene* scene)
 
 			SetObjectMatrices(cameraTransformation, glm::mat4x4(I_MATRIX));
 
-			const std::pair<std::vector<glm::vec3>, std::pair<std::vector<glm::vec3>, std::vector<glm::vec3>>>* cameraVertices = camera->Render();
+			MESH_VIEW cameraView = camera->Render();
+
+			DrawTriangles(scene, cameraView.vertices, cameraView.indices, FALSE, NULL, 1, IS_CAMERA, NULL, cameraView.edges);
+		}
+	}
+
+	scene->SetCullingStats(cullingStats);
+
+	// Lines drawn between frames go straight to the color buffer
+	FlushTiles();
+	useTiles = false;
+}
+
+void Renderer::DrawPagedModel(Scene* scene, PagedMeshModel* model)
+{
+	const std::shared_ptr<PagedMesh>& pagedMesh = model->GetPagedMesh();
+
+	SetObjectMatrices(model->GetModelTransformation(), model->GetNormalTransformation());
+	SetWorldTransformation(scene->GetWorldTransformation());
+
+	glm::mat4x4 viewVolumeTransformation = GetViewVolumeTransformation(scene);
+
+	// Nothing is paged in for a model out of view, what is resident stays for when it comes back
+	if (IsOutsideView(viewVolumeTransformation, *model->GetGeometry())) {
+		cullingStats.culledModels++;
+		return;
+	}
 
-			DrawTriangles(scene, &cameraVertices->first, FALSE, NULL, 1, IS_CAMERA);
+	cullingStats.visibleModels++;
+	pagedMesh->UpdateResidency(viewVolumeTransformation);
 
-			delete cameraVertices;
+	for (const PAGED_CHUNK& chunk : pagedMesh->GetChunks())
+	{
+		if (chunk.resident) {
+			DrawTriangles(scene, chunk.vertices, chunk.indices, scene->ShouldShowFacesNormals(), &model->GetCentroid(), 1, FALSE, NULL, chunk.edges);
 		}
 	}
 
-	SwapBuffers();
+	if (scene->ShouldShowBorderCube()) {
+		DrawBorderCube(scene, model->GetBorderCube());
+	}
 }
 
 void Renderer::DrawAxis(Scene* scene)
@@ -152,28 +320,64 @@ void Renderer::DrawAxis(Scene* scene)
 
 void Renderer::DrawLine(const glm::uvec2& p1, const glm::uvec2& p2, const glm::vec3& color)
 {
-	float dx, dy;
-
 	float x1 = p1.x;
 	float x2 = p2.x;
 	float y1 = p1.y;
 	float y2 = p2.y;
 
+	if (!useTiles) {
+		RasterizeLine(x1, y1, x2, y2, color, 0, 0, viewportWidth, viewportHeight);
+		return;
+	}
+
+	// Pixel positions are never negative, a line starting past the viewport has nothing in it
+	float minX = std::min(x1, x2), minY = std::min(y1, y2);
+
+	if (minX >= viewportWidth || minY >= viewportHeight) {
+		return;
+	}
+
+	RASTER_PRIMITIVE line;
+	line.points[0] = glm::vec3(x1, y1, 0.0f);
+	line.points[1] = glm::vec3(x2, y2, 0.0f);
+	line.color = color;
+	line.isLine = true;
+
+	BinPrimitive(line, (int) minX, (int) minY, (int) std::min(std::max(x1, x2), viewportWidth - 1.0f), (int) std::min(std::max(y1, y2), viewportHeight - 1.0f));
+}
+
+void Renderer::RasterizeLine(float x1, float y1, float x2, float y2, const glm::vec3& color, int minX, int minY, int maxX, int maxY)
+{
+	float dx, dy;
+
 	const bool step = IsSlopeBiggerThanOne(x1, x2, y1, y2);
 
 	OrderPoints(x1, x2, y1, y2);
 
 	GetDeltas(x1, x2, y1, y2, &dx, &dy);
 
+	// Steep lines are walked along y, the rectangle is turned with them
+	if (step) {
+		std::swap(minX, minY);
+		std::swap(maxX, maxY);
+	}
+
+	if (x1 >= maxX) {
+		return;
+	}
+
 	float error = dx / 2.0f;
 	const int ystep = (y1 < y2) ? 1 : -1;
-	int y = (int)y1;
+	int64_t y = (int64_t)y1;
 
-	const int maxX = (int)x2;
+	// The walk stops at the end of the rectangle, before its start it only keeps error and y up to date
+	const int lastX = (int)std::min(x2, (float)maxX);
 
-	for (int x = (int)x1; x < maxX; x++)
+	for (int x = (int)x1; x < lastX; x++)
 	{
-		PutPixel(x, y, step, color);
+		if (x >= minX && y >= minY && y < maxY) {
+			PutPixel(x, (int)y, step, color);
+		}
 
 		yStepErrorUpdate(dx, dy, error, y, ystep);
 	}
@@ -186,8 +390,8 @@ glm::uvec2 Renderer::ToViewPlane(const glm::vec2& point)
 	screenPoint.x = ((point.x + 1) * viewportWidth / 2.0f);
 	screenPoint.y = ((point.y + 1) * viewportHeight / 2.0f);
 
-	screenPoint.x = round((screenPoint.x - (viewportWidth / 2.0f)) * (500.0f / viewportWidth) + (viewportWidth / 2.0f));
-	screenPoint.y = round((screenPoint.y - (viewportHeight / 2.0f)) * (500.0f / viewportHeight) + (viewportHeight / 2.0f));
+	screenPoint.x = round((screenPoint.x - (viewportWidth / 2.0f)) * (2.0f * SCREEN_SCALE / viewportWidth) + (viewportWidth / 2.0f));
+	screenPoint.y = round((screenPoint.y - (viewportHeight / 2.0f)) * (2.0f * SCREEN_SCALE / viewportHeight) + (viewportHeight / 2.0f));
 
 	return glm::vec2(screenPoint.x, screenPoint.y);
 }
@@ -213,32 +417,176 @@ void Renderer::PutPixel(int x, int y, bool step, const glm::vec3& color)
 	}
 }
 
-void Renderer::DrawTriangles(Scene* scene, const std::vector<glm::vec3>* vertices, bool shouldDrawFaceNormals /*= false*/, const glm::vec3* modelCentroid /*= NULL*/, UINT32 normScaleRate /*= 1*/, bool isCamera /*= false*/)
+glm::mat4x4 Renderer::GetScreenMapping(const glm::mat4x4& projection)
+{
+	// Depth grows away from the viewer with the orthographic and perspective projections, but shrinks without a
+	// projection (the identity). Compare two points straight ahead and turn depth around where needed.
+	glm::vec4 nearPoint = projection * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+	glm::vec4 farPoint = projection * glm::vec4(0.0f, 0.0f, -2.0f, 1.0f);
+	float depthDirection = farPoint.z / farPoint.w < nearPoint.z / nearPoint.w ? -1.0f : 1.0f;
+
+	// The same mapping as ToViewPlane: x * SCREEN_SCALE + width / 2, without rounding
+	return glm::mat4x4(TRANSLATION_MATRIX(viewportWidth / 2.0f, viewportHeight / 2.0f, 0.0f)) * glm::mat4x4(HOMOGENEOUS_MATRIX4(SCREEN_SCALE, SCREEN_SCALE, depthDirection, 1.0f));
+}
+
+glm::mat4x4 Renderer::GetScreenTransformation(Scene* scene)
+{
+	glm::mat4x4 projection = scene->GetActiveCameraProjection();
+
+	return GetScreenMapping(projection) * projection * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation;
+}
+
+bool Renderer::IsOutsideView(const glm::mat4x4& viewVolumeTransformation, const MeshGeometry& geometry)
+{
+	return PagedMesh::IsOutsideViewVolume(viewVolumeTransformation, &geometry.GetMinCoordinates().x, &geometry.GetMaxCoordinates().x);
+}
+
+glm::mat4x4 Renderer::GetViewVolumeTransformation(Scene* scene)
+{
+	// ToViewPlane shows [-width / 2, width / 2] x [-height / 2, height / 2] pixels around the center, SCREEN_SCALE pixels per unit
+	// of the projection plane. Scaling that area to [-1, 1] gives the view volume
+	glm::mat4x4 screenScaling = glm::mat4x4(HOMOGENEOUS_MATRIX4(2.0f * SCREEN_SCALE / viewportWidth, 2.0f * SCREEN_SCALE / viewportHeight, 1.0f, 1.0f));
+
+	return screenScaling * scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation;
+}
+
+size_t Renderer::GetLodFaceBudget(Scene* scene, const MeshGeometry& geometry)
+{
+	glm::mat4x4 transformation = GetScreenTransformation(scene);
+	const glm::vec3& minCoordinates = geometry.GetMinCoordinates();
+	const glm::vec3& maxCoordinates = geometry.GetMaxCoordinates();
+	float left = 0, right = 0, bottom = 0, top = 0;
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 point((corner & 1) ? maxCoordinates.x : minCoordinates.x, (corner & 2) ? maxCoordinates.y : minCoordinates.y, (corner & 4) ? maxCoordinates.z : minCoordinates.z);
+		glm::vec4 projected = transformation * Utils::ToHomogeneousForm(point);
+
+		// Bounds reaching behind the camera may cover any part of the screen
+		if (projected.w <= 0) {
+			return (size_t) -1;
+		}
+
+		float x = projected.x / projected.w;
+		float y = projected.y / projected.w;
+
+		left = corner == 0 || x < left ? x : left;
+		right = corner == 0 || x > right ? x : right;
+		bottom = corner == 0 || y < bottom ? y : bottom;
+		top = corner == 0 || y > top ? y : top;
+	}
+
+	// Only the part inside the viewport counts
+	left = fmax(left, 0.0f);
+	bottom = fmax(bottom, 0.0f);
+	right = fmin(right, (float) viewportWidth);
+	top = fmin(top, (float) viewportHeight);
+
+	if (right <= left || top <= bottom) {
+		return 0;
+	}
+
+	return (size_t) ((right - left) * (top - bottom) / LOD_PIXELS_PER_FACE);
+}
+
+void Renderer::TransformVertices(const glm::mat4x4& transformation, Span<const glm::vec3> vertices, const VERTEX_STREAMS* vertexStreams)
+{
+	// The buffer only ever grows, so after the first frames drawing allocates nothing
+	if (screenVertices.size() < vertices.size()) {
+		screenVertices.resize(vertices.size());
+	}
+
+	// The SIMD kernel picked for this CPU, from the x/y/z arrays or straight from the packed vertices
+	if (vertexStreams) {
+		TransformKernels::Transform(*vertexStreams, transformation, screenVertices.data());
+	}
+	else if (!vertices.empty()) {
+		TransformKernels::Transform(vertices.data(), vertices.size(), transformation, screenVertices.data());
+	}
+}
+
+void Renderer::DrawInstancedModel(Scene* scene, InstancedMeshModel* model)
 {
-	std::vector<glm::vec3>::const_iterator it = vertices->begin();
+	MESH_VIEW modelView = model->Render();
+	const VERTEX_STREAMS* vertexStreams = scene->ShouldUseVertexStreams() ? &model->GetGeometry()->GetPositionStreams() : NULL;
+	glm::mat4x4 projection = scene->GetActiveCameraProjection();
+	glm::mat4x4 viewTransformation = GetScreenMapping(projection) * projection * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * model->GetModelTransformation();
 
-	while (it != vertices->end())
+	SetObjectMatrices(model->GetModelTransformation(), model->GetNormalTransformation());
+	SetWorldTransformation(scene->GetWorldTransformation());
+
+	glm::mat4x4 viewVolumeTransformation = GetViewVolumeTransformation(scene);
+	size_t visibleInstances = cullingStats.visibleInstances;
+
+	// All instances walk the same small geometry, which stays in cache from the first instance to the last
+	for each (const MODEL_INSTANCE& instance in model->GetInstances())
 	{
-		glm::vec3 p1 = *(it++);
-		if (it == vertices->end()) break;
-		glm::vec3 p2 = *(it++);
-		if (it == vertices->end()) break;
-		glm::vec3 p3 = *(it++);
+		if (IsOutsideView(viewVolumeTransformation * instance.transformation, *model->GetGeometry())) {
+			cullingStats.culledInstances++;
+			continue;
+		}
 
-		glm::vec3 nrm1 = p1;
-		glm::vec3 nrm2 = p2;
-		glm::vec3 nrm3 = p3;
+		cullingStats.visibleInstances++;
+		glm::vec3 color = glm::vec3(instance.color);
 
-		p1 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(p1));
-		p2 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(p2));
-		p3 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(p3));
+		TransformVertices(viewTransformation * instance.transformation, modelView.vertices, vertexStreams);
 
-		DrawLine(ToViewPlane(p1), ToViewPlane(p2), COLOR(WHITE));
-		DrawLine(ToViewPlane(p2), ToViewPlane(p3), COLOR(WHITE));
-		DrawLine(ToViewPlane(p3), ToViewPlane(p1), COLOR(WHITE));
+		if (scene->GetRenderMode() == RENDER_SOLID) {
+			SetObjectMatrices(model->GetModelTransformation() * instance.transformation, model->GetNormalTransformation());
+			FillTriangles(modelView.vertices, modelView.indices, GetViewDirection(scene), color);
+		}
+		else {
+			DrawEdges(modelView.edges, color);
+		}
+
+		if (scene->ShouldShowBorderCube()) {
+			SetObjectMatrices(model->GetModelTransformation() * instance.transformation, model->GetNormalTransformation());
+			DrawBorderCube(scene, model->GetBorderCube());
+		}
+	}
+
+	if (cullingStats.visibleInstances > visibleInstances) {
+		cullingStats.visibleModels++;
+	}
+	else {
+		cullingStats.culledModels++;
+	}
+}
+
+void Renderer::DrawTriangles(Scene* scene, Span<const glm::vec3> vertices, Span<const uint32_t> indices, bool shouldDrawFaceNormals /*= false*/, const glm::vec3* modelCentroid /*= NULL*/, UINT32 normScaleRate /*= 1*/, bool isCamera /*= false*/, const VERTEX_STREAMS* vertexStreams /*= NULL*/, Span<const uint32_t> edges /*= Span<const uint32_t>()*/)
+{
+	// Every welded vertex is transformed once, the triangles then only look the results up
+	glm::mat4x4 screenTransformation = GetScreenTransformation(scene);
+	TransformVertices(screenTransformation, vertices, vertexStreams);
+	bool isWireframe = scene->GetRenderMode() == RENDER_WIREFRAME;
+
+	if (!isWireframe) {
+		FillTriangles(vertices, indices, GetViewDirection(scene), COLOR(WHITE));
+	}
+	// With an edge list every edge shared by two faces is drawn once instead of twice
+	else if (!edges.empty()) {
+		DrawEdges(edges, COLOR(WHITE));
+	}
+
+	if ((!isWireframe || !edges.empty()) && !scene->ShouldShowFacesNormals()) {
+		return;
+	}
+
+	for (size_t i = 0; i + FACE_ELEMENTS <= indices.size(); i += FACE_ELEMENTS)
+	{
+		if (isWireframe && edges.empty())
+		{
+			DrawLine(indices[i], indices[i + 1], COLOR(WHITE));
+			DrawLine(indices[i + 1], indices[i + 2], COLOR(WHITE));
+			DrawLine(indices[i + 2], indices[i], COLOR(WHITE));
+		}
 
 		if (scene->ShouldShowFacesNormals())
 		{
+			const glm::vec3& nrm1 = vertices[indices[i]];
+			const glm::vec3& nrm2 = vertices[indices[i + 1]];
+			const glm::vec3& nrm3 = vertices[indices[i + 2]];
+
 			glm::vec3 subs1 = nrm3 - nrm1;
 			glm::vec3 subs2 = nrm2 - nrm1;
 			glm::vec3 faceNormal = glm::cross(subs1, subs2);
@@ -248,36 +596,243 @@ void Renderer::DrawTriangles(Scene* scene, const std::vector<glm::vec3>* vertice
 			glm::vec3 normalizedFaceNormal = Utils::IsVecEqual(faceNormal, glm::vec3(0, 0, 0)) ? faceNormal : glm::normalize(faceNormal);
 
 			normalizedFaceNormal /= 2.5f;
-			glm::vec3 nP1 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(faceCenter));
-			glm::vec3 nP2 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(faceCenter + normalizedFaceNormal));
+			glm::vec3 nP1 = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(faceCenter));
+			glm::vec3 nP2 = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(faceCenter + normalizedFaceNormal));
 
-			DrawLine(ToViewPlane(nP1), ToViewPlane(nP2), COLOR(LIME));
+			DrawLine(ToPixel(nP1), ToPixel(nP2), COLOR(LIME));
 		}
 	}
 }
 
-void Renderer::DrawVerticesNormals(Scene* scene, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
+void Renderer::DrawEdges(Span<const uint32_t> edges, const glm::vec3& color)
 {
+	for (size_t i = 0; i + 1 < edges.size(); i += 2)
+	{
+		DrawLine(edges[i], edges[i + 1], color);
+	}
+}
+
+void Renderer::DrawLine(uint32_t first, uint32_t second, const glm::vec3& color)
+{
+	DrawLine(ToPixel(screenVertices[first]), ToPixel(screenVertices[second]), color);
+}
+
+glm::vec3 Renderer::GetViewDirection(Scene* scene)
+{
+	// The camera looks down its -z axis, so +z points back at the viewer
+	glm::mat4x4 viewTransformation = scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation;
+	glm::vec3 direction = glm::vec3(glm::inverse(viewTransformation) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
+
+	return Utils::IsVecEqual(direction, glm::vec3(0, 0, 0)) ? direction : glm::normalize(direction);
+}
+
+void Renderer::FillTriangles(Span<const glm::vec3> vertices, Span<const uint32_t> indices, const glm::vec3& viewDirection, const glm::vec3& color)
+{
+	for (size_t i = 0; i + FACE_ELEMENTS <= indices.size(); i += FACE_ELEMENTS)
+	{
+		// Flat shading with the light at the viewer, lighting both sides since meshes may be open
+		const glm::vec3& p1 = vertices[indices[i]];
+		glm::vec3 faceNormal = glm::cross(vertices[indices[i + 1]] - p1, vertices[indices[i + 2]] - p1);
+		float normalLength = glm::length(faceNormal);
+		float facing = normalLength > 0 ? fabs(glm::dot(faceNormal, viewDirection)) / normalLength : 0.0f;
+
+		DrawTriangle(screenVertices[indices[i]], screenVertices[indices[i + 1]], screenVertices[indices[i + 2]],
+			color * (RASTER_AMBIENT + (1.0f - RASTER_AMBIENT) * facing));
+	}
+}
+
+void Renderer::DrawTriangle(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& color)
+{
+	if (!useTiles) {
+		RasterizeTriangle(p1, p2, p3, color, 0, 0, viewportWidth, viewportHeight);
+		return;
+	}
+
+	if (!IsInGuardBand(p1, p2, p3)) {
+		return;
+	}
+
+	// Snapping to subpixels moves a corner by less than a pixel, so these bounds hold every pixel it sets
+	float left = floor(std::min(p1.x, std::min(p2.x, p3.x)));
+	float right = floor(std::max(p1.x, std::max(p2.x, p3.x))) + 1.0f;
+	float bottom = floor(std::min(p1.y, std::min(p2.y, p3.y)));
+	float top = floor(std::max(p1.y, std::max(p2.y, p3.y))) + 1.0f;
+
+	if (right < 0 || top < 0 || left >= viewportWidth || bottom >= viewportHeight) {
+		return;
+	}
+
+	RASTER_PRIMITIVE triangle;
+	triangle.points[0] = p1;
+	triangle.points[1] = p2;
+	triangle.points[2] = p3;
+	triangle.color = color;
+	triangle.isLine = false;
+
+	BinPrimitive(triangle, (int) std::max(left, 0.0f), (int) std::max(bottom, 0.0f), (int) std::min(right, viewportWidth - 1.0f), (int) std::min(top, viewportHeight - 1.0f));
+}
+
+void Renderer::BinPrimitive(const RASTER_PRIMITIVE& primitive, int left, int bottom, int right, int top)
+{
+	uint32_t index = (uint32_t) primitives.size();
+	primitives.push_back(primitive);
+
+	for (int row = bottom / RASTER_TILE_SIZE; row <= top / RASTER_TILE_SIZE; row++)
+	{
+		for (int column = left / RASTER_TILE_SIZE; column <= right / RASTER_TILE_SIZE; column++)
+		{
+			tileBins[row * tileColumns + column].push_back(index);
+		}
+	}
+
+	if (primitives.size() >= RASTER_MAX_BINNED) {
+		FlushTiles();
+	}
+}
+
+void Renderer::FlushTiles()
+{
+	if (primitives.empty()) {
+		return;
+	}
+
+	// Every tile writes only its own pixels of the color and depth buffers, so the tiles need no locking
+	workerPool.Run(tileBins.size(), [this](size_t tile) {
+		std::vector<uint32_t>& bin = tileBins[tile];
+		int minX = (int) (tile % tileColumns) * RASTER_TILE_SIZE;
+		int minY = (int) (tile / tileColumns) * RASTER_TILE_SIZE;
+		int maxX = std::min(minX + RASTER_TILE_SIZE, viewportWidth);
+		int maxY = std::min(minY + RASTER_TILE_SIZE, viewportHeight);
+
+		for each (uint32_t index in bin)
+		{
+			const RASTER_PRIMITIVE& primitive = primitives[index];
+
+			if (primitive.isLine) {
+				RasterizeLine(primitive.points[0].x, primitive.points[0].y, primitive.points[1].x, primitive.points[1].y, primitive.color, minX, minY, maxX, maxY);
+			}
+			else {
+				RasterizeTriangle(primitive.points[0], primitive.points[1], primitive.points[2], primitive.color, minX, minY, maxX, maxY);
+			}
+		}
+
+		bin.clear();
+	});
+
+	primitives.clear();
+}
+
+void Renderer::RasterizeTriangle(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& color, int minX, int minY, int maxX, int maxY)
+{
+	// Like lines, triangles are not clipped against the near and far planes
+	if (!IsInGuardBand(p1, p2, p3)) {
+		return;
+	}
+
+	int64_t x1 = (int64_t) floor(p1.x * RASTER_SUBPIXELS + 0.5f), y1 = (int64_t) floor(p1.y * RASTER_SUBPIXELS + 0.5f);
+	int64_t x2 = (int64_t) floor(p2.x * RASTER_SUBPIXELS + 0.5f), y2 = (int64_t) floor(p2.y * RASTER_SUBPIXELS + 0.5f);
+	int64_t x3 = (int64_t) floor(p3.x * RASTER_SUBPIXELS + 0.5f), y3 = (int64_t) floor(p3.y * RASTER_SUBPIXELS + 0.5f);
+	float z1 = p1.z, z2 = p2.z, z3 = p3.z;
+	int64_t area = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+
+	if (area == 0) {
+		return;
+	}
+
+	// Both windings are drawn, turned so that the edge functions are positive inside
+	if (area < 0) {
+		std::swap(x2, x3);
+		std::swap(y2, y3);
+		std::swap(z2, z3);
+		area = -area;
+	}
+
+	// Pixels whose centers may be covered, inside [minX, maxX) x [minY, maxY)
+	int left = (int) std::max<int64_t>(minX, std::min(x1, std::min(x2, x3)) >> RASTER_SUBPIXEL_BITS);
+	int right = (int) std::min<int64_t>(maxX - 1, std::max(x1, std::max(x2, x3)) >> RASTER_SUBPIXEL_BITS);
+	int bottom = (int) std::max<int64_t>(minY, std::min(y1, std::min(y2, y3)) >> RASTER_SUBPIXEL_BITS);
+	int top = (int) std::min<int64_t>(maxY - 1, std::max(y1, std::max(y2, y3)) >> RASTER_SUBPIXEL_BITS);
+
+	if (left > right || bottom > top) {
+		return;
+	}
+
+	// Edge functions e = a * x + b * y + c of the edges opposite each corner, at the first pixel center.
+	// Every edge value is exact, so a pixel gets the same result whichever pixel the walk started from.
+	int64_t a1 = y2 - y3, b1 = x3 - x2;
+	int64_t a2 = y3 - y1, b2 = x1 - x3;
+	int64_t a3 = y1 - y2, b3 = x2 - x1;
+	int64_t startX = (int64_t) left * RASTER_SUBPIXELS + RASTER_SUBPIXELS / 2;
+	int64_t startY = (int64_t) bottom * RASTER_SUBPIXELS + RASTER_SUBPIXELS / 2;
+	int64_t row1 = a1 * (startX - x2) + b1 * (startY - y2);
+	int64_t row2 = a2 * (startX - x3) + b2 * (startY - y3);
+	int64_t row3 = a3 * (startX - x1) + b3 * (startY - y1);
+
+	// Top-left rule: a pixel center exactly on an edge belongs to one of the two triangles sharing it
+	int64_t bias1 = (a1 > 0 || (a1 == 0 && b1 < 0)) ? 0 : 1;
+	int64_t bias2 = (a2 > 0 || (a2 == 0 && b2 < 0)) ? 0 : 1;
+	int64_t bias3 = (a3 > 0 || (a3 == 0 && b3 < 0)) ? 0 : 1;
+
+	// Depth is interpolated from the edge values of corners 2 and 3, which are their barycentric weights times area
+	float depthStep2 = (z2 - z1) / area;
+	float depthStep3 = (z3 - z1) / area;
+
+	for (int y = bottom; y <= top; y++)
+	{
+		int64_t e1 = row1, e2 = row2, e3 = row3;
+
+		for (int x = left; x <= right; x++)
+		{
+			if (((e1 - bias1) | (e2 - bias2) | (e3 - bias3)) >= 0)
+			{
+				float depth = z1 + depthStep2 * (float) e2 + depthStep3 * (float) e3;
+				int pixel = x + y * viewportWidth;
+
+				if (depth < zBuffer[pixel]) {
+					zBuffer[pixel] = depth;
+					colorBuffer[pixel * 3] = color.x;
+					colorBuffer[pixel * 3 + 1] = color.y;
+					colorBuffer[pixel * 3 + 2] = color.z;
+				}
+			}
+
+			e1 += a1 * RASTER_SUBPIXELS;
+			e2 += a2 * RASTER_SUBPIXELS;
+			e3 += a3 * RASTER_SUBPIXELS;
+		}
+
+		row1 += b1 * RASTER_SUBPIXELS;
+		row2 += b2 * RASTER_SUBPIXELS;
+		row3 += b3 * RASTER_SUBPIXELS;
+	}
+}
+
+void Renderer::DrawVerticesNormals(Scene* scene, Span<const glm::vec3> vertices, Span<const glm::vec3> normals)
+{
+	glm::mat4x4 screenTransformation = GetScreenTransformation(scene);
+
 	for (int i = 0; i < normals.size() && i < vertices.size(); i++)
 	{
 		glm::vec3 vertex = vertices[i];
 		glm::vec3 vertexNormal = normals[i];
 
-		glm::vec3 nP1 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(vertex));
-		glm::vec3 nP2 = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(vertex + vertexNormal / 2.5f));
+		glm::vec3 nP1 = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(vertex));
+		glm::vec3 nP2 = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(vertex + vertexNormal / 2.5f));
 
-		DrawLine(ToViewPlane(nP1), ToViewPlane(nP2), COLOR(RED));
+		DrawLine(ToPixel(nP1), ToPixel(nP2), COLOR(RED));
 	}
 }
 
-void Renderer::DrawBorderCube(Scene* scene, CUBE_LINES& borderCube)
+void Renderer::DrawBorderCube(Scene* scene, const CUBE_LINES& borderCube)
 {
+	glm::mat4x4 screenTransformation = GetScreenTransformation(scene);
+
 	for each (std::pair<glm::vec3, glm::vec3> line in borderCube.line)
 	{
-		glm::vec3 pStart = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(line.first));
-		glm::vec3 pEnd = Utils::ToCartesianForm(scene->GetActiveCameraProjection() * scene->GetActiveCameraTransformation() * scene->GetWorldTransformation() * objectTranformation * Utils::ToHomogeneousForm(line.second));
+		glm::vec3 pStart = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(line.first));
+		glm::vec3 pEnd = Utils::ToCartesianForm(screenTransformation * Utils::ToHomogeneousForm(line.second));
 
-		DrawLine(ToViewPlane(pStart), ToViewPlane(pEnd), COLOR(BLUE));
+		DrawLine(ToPixel(pStart), ToPixel(pEnd), COLOR(BLUE));
 	}
 }
 
@@ -300,7 +855,7 @@ void Renderer::GetDeltas(IN float x1, IN float x2, IN float y1, IN float y2, OUT
 	*pDy = fabs(y2 - y1);
 }
 
-void Renderer::yStepErrorUpdate(float dx, float dy, float& error, int& y, const int& ystep)
+void Renderer::yStepErrorUpdate(float dx, float dy, float& error, int64_t& y, const int& ystep)
 {
 	error -= dy;
 	if (error < 0)
@@ -421,4 +976,75 @@ void Renderer::SwapBuffers()
 
 	// Finally renders the data.
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-}
\ No newline at end of file
+}
+
+void Renderer::Benchmark(const std::string& directory)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((directory + "\\*.obj").c_str(), &findData);
+
+	if (findHandle == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "No .obj files were found in %s\n", directory.c_str());
+		return;
+	}
+
+	const RENDER_MODE modes[] = { RENDER_WIREFRAME, RENDER_SOLID };
+	const size_t pixelCount = (size_t) viewportWidth * viewportHeight;
+
+	printf("Frame times in milliseconds at %d x %d, tiles rasterized on %u threads\n", viewportWidth, viewportHeight, (unsigned int) workerPool.GetThreadCount());
+	printf("%-20s %10s %10s %10s %10s %10s\n", "Model", "Faces", "Mode", "Direct", "Tiled", "Identical");
+
+	do
+	{
+		std::shared_ptr<MeshModel> model = Utils::LoadMeshModel(directory + "\\" + findData.cFileName, nullptr);
+
+		if (!model) {
+			continue;
+		}
+
+		// The startup view of the model. Levels of detail are built in the background, so they are left out
+		// to have both frames draw the same triangles.
+		Scene scene;
+		scene.AddModel(model);
+		scene.UseLevelOfDetail(false);
+
+		for each (RENDER_MODE mode in modes)
+		{
+			std::vector<float> colors[2];
+			std::vector<float> depths[2];
+			double milliseconds[2];
+
+			scene.SetRenderMode(mode);
+
+			for (int tiled = 0; tiled < 2; tiled++)
+			{
+				scene.UseTiledRasterizer(tiled == 1);
+				milliseconds[tiled] = DBL_MAX;
+
+				// Keep the best of a few runs
+				for (int i = 0; i < BENCHMARK_REPETITIONS; i++)
+				{
+					ClearColorBuffer(glm::vec3(0.0f, 0.0f, 0.0f));
+					ClearDepthBuffer();
+
+					auto start = std::chrono::high_resolution_clock::now();
+					DrawScene(&scene);
+					milliseconds[tiled] = fmin(milliseconds[tiled], std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+				}
+
+				colors[tiled].assign(colorBuffer, colorBuffer + pixelCount * 3);
+				depths[tiled].assign(zBuffer, zBuffer + pixelCount);
+			}
+
+			// The tiled frame has to match the direct one bit for bit, depths included
+			bool isIdentical = memcmp(colors[0].data(), colors[1].data(), colors[0].size() * sizeof(float)) == 0 &&
+				memcmp(depths[0].data(), depths[1].data(), depths[0].size() * sizeof(float)) == 0;
+
+			printf("%-20s %10u %10s %10.2f %10.2f %10s\n", findData.cFileName, (unsigned int) (model->GetGeometry()->GetIndexBuffer().size() / FACE_ELEMENTS),
+				mode == RENDER_SOLID ? "Solid" : "Wireframe", milliseconds[0], milliseconds[1], isIdentical ? "yes" : "no");
+		}
+
+	} while (FindNextFileA(findHandle, &findData));
+
+	FindClose(findHandle);
+}
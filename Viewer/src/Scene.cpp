@@ -2,9 +2,13 @@
 #include "MeshModel.h"
 #include "Constants.h"
 #include "Camera.h"
+#include "PrimitiveGenerator.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
 #include <string>
 
-Scene::Scene() : activeCameraIndex(DISABLED), activeModelIndex(DISABLED), worldTransformation(I_MATRIX), drawVerticesNormals(false)
+Scene::Scene() : activeCameraIndex(DISABLED), activeModelIndex(DISABLED), worldTransformation(I_MATRIX), drawVerticesNormals(false), useVertexStreams(false), useLevelOfDetail(true), useTiledRasterizer(true), renderMode(RENDER_WIREFRAME), cullingStats()
 {
 
 }
@@ -16,6 +20,28 @@ void Scene::AddModel(const std::shared_ptr<MeshModel>& model)
 	SetActiveModelIndex(models.size() - 1);
 }
 
+void Scene::RemoveModel(const std::shared_ptr<MeshModel>& model)
+{
+	auto found = std::find(models.begin(), models.end(), model);
+
+	if (found == models.end()) {
+		return;
+	}
+
+	int index = (int) (found - models.begin());
+	models.erase(found);
+
+	// Keep the same model active, unless it was the removed one
+	if (index < activeModelIndex || activeModelIndex >= (int) models.size()) {
+		activeModelIndex--;
+	}
+}
+
+bool Scene::HasModel(const std::shared_ptr<MeshModel>& model) const
+{
+	return std::find(models.begin(), models.end(), model) != models.end();
+}
+
 const int Scene::GetModelCount() const
 {
 	return models.size();
@@ -34,9 +60,59 @@ const int Scene::GetActiveModelIndex() const
 	return activeModelIndex;
 }
 
-void Scene::AddPrimitiveModel(PRIMITIVE primitiveModel)
+void Scene::AddPrimitiveModel(PRIMITIVE primitiveModel, unsigned int tessellationLevel)
 {
-	std::shared_ptr<MeshModel> model = std::make_shared<MeshModel>(PrimMeshModel(primitiveModel));
+	std::shared_ptr<MeshModel> model = std::make_shared<PrimMeshModel>(primitiveModel, tessellationLevel);
+	models.push_back(model);
+	SetActiveModelIndex(models.size() - 1);
+}
+
+void Scene::AddPrimitiveModels(PRIMITIVE primitiveModel, unsigned int count, unsigned int tessellationLevel)
+{
+	if (count == 0) {
+		return;
+	}
+
+	// Lay the models out on a square grid in the XZ plane, centered around the origin
+	unsigned int columns = (unsigned int) ceil(sqrt((double) count));
+	float offset = (columns - 1) * PRIMITIVES_GRID_SPACING / 2.0f;
+
+	models.reserve(models.size() + count);
+
+	for (unsigned int i = 0; i < count; i++) {
+		std::shared_ptr<MeshModel> model = std::make_shared<PrimMeshModel>(primitiveModel, tessellationLevel);
+		float x = (i % columns) * PRIMITIVES_GRID_SPACING - offset;
+		float z = (i / columns) * PRIMITIVES_GRID_SPACING - offset;
+
+		model->SetModelTransformation(glm::mat4x4(TRANSLATION_MATRIX(x, 0, z)));
+		models.push_back(model);
+	}
+
+	SetActiveModelIndex(models.size() - 1);
+}
+
+void Scene::AddPrimitiveInstances(PRIMITIVE primitiveModel, unsigned int count, unsigned int tessellationLevel)
+{
+	if (count == 0) {
+		return;
+	}
+
+	const COLOR palette[] = { WHITE, RED, YELLOW, LIME, BLUE, X_COL, Y_COL, Z_COL };
+	const unsigned int paletteSize = sizeof(palette) / sizeof(palette[0]);
+
+	std::shared_ptr<InstancedMeshModel> model = std::make_shared<InstancedMeshModel>(PrimitiveGenerator::GetGeometry(primitiveModel, tessellationLevel), PRIMITIVES.at(primitiveModel) + " instances");
+	unsigned int columns = (unsigned int) ceil(sqrt((double) count));
+	float offset = (columns - 1) * PRIMITIVES_GRID_SPACING / 2.0f;
+
+	model->ReserveInstances(count);
+
+	for (unsigned int i = 0; i < count; i++) {
+		float x = (i % columns) * PRIMITIVES_GRID_SPACING - offset;
+		float z = (i / columns) * PRIMITIVES_GRID_SPACING - offset;
+
+		model->AddInstance(glm::mat4x4(TRANSLATION_MATRIX(x, 0, z)), glm::vec4(COLOR(palette[i % paletteSize]), 1.0f));
+	}
+
 	models.push_back(model);
 	SetActiveModelIndex(models.size() - 1);
 }
@@ -56,6 +132,56 @@ void Scene::DeleteActiveModel()
 	}
 }
 
+// Casts the ray under viewPoint through geometry drawn with transformation. The ray runs from the near to the far
+// plane, so distances in [0, 1] are comparable between all models.
+static bool PickGeometry(const MeshGeometry& geometry, const glm::mat4x4& transformation, const glm::vec2& viewPoint, float& distance, int& face)
+{
+	glm::mat4x4 inverseTransformation = glm::inverse(transformation);
+	glm::vec3 nearPoint = Utils::ToCartesianForm(inverseTransformation * glm::vec4(viewPoint.x, viewPoint.y, -1.0f, 1.0f));
+	glm::vec3 farPoint = Utils::ToCartesianForm(inverseTransformation * glm::vec4(viewPoint.x, viewPoint.y, 1.0f, 1.0f));
+	BVH_HIT hit;
+
+	if (!geometry.GetBvh().Intersect(geometry.GetVertexBuffer(), geometry.GetIndexBuffer(), nearPoint, farPoint - nearPoint, distance, hit)) {
+		return false;
+	}
+
+	distance = hit.distance;
+	face = (int) hit.face;
+
+	return true;
+}
+
+int Scene::PickModel(const glm::vec2& viewPoint, int& face)
+{
+	glm::mat4x4 viewTransformation = GetActiveCameraProjection() * GetActiveCameraTransformation() * worldTransformation;
+	float distance = 1.0f;
+	int pickedModel = DISABLED;
+
+	face = DISABLED;
+
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		// Paged models keep their triangles outside the geometry, their bounds only geometry is never hit
+		const MeshGeometry& geometry = *models[i]->GetGeometry();
+		glm::mat4x4 modelTransformation = viewTransformation * models[i]->GetModelTransformation();
+		std::shared_ptr<InstancedMeshModel> instancedModel = std::dynamic_pointer_cast<InstancedMeshModel>(models[i]);
+
+		if (instancedModel) {
+			for each (const MODEL_INSTANCE& instance in instancedModel->GetInstances())
+			{
+				pickedModel = PickGeometry(geometry, modelTransformation * instance.transformation, viewPoint, distance, face) ? (int) i : pickedModel;
+			}
+		}
+		else if (PickGeometry(geometry, modelTransformation, viewPoint, distance, face)) {
+			pickedModel = (int) i;
+		}
+	}
+
+	SetActiveModelIndex(pickedModel);
+
+	return pickedModel;
+}
+
 // Camera related functions implementation
 void Scene::AddCamera(Camera* camera)
 {
@@ -322,6 +448,26 @@ void Scene::ShowBorderCube(const bool key)
 	drawBorderCube = key;
 }
 
+void Scene::UseVertexStreams(const bool key)
+{
+	useVertexStreams = key;
+}
+
+void Scene::UseLevelOfDetail(const bool key)
+{
+	useLevelOfDetail = key;
+}
+
+void Scene::UseTiledRasterizer(const bool key)
+{
+	useTiledRasterizer = key;
+}
+
+void Scene::SetRenderMode(const RENDER_MODE mode)
+{
+	renderMode = mode;
+}
+
 void Scene::ScaleActiveModel(const float scaleFactor)
 {
 	if (activeModelIndex != DISABLED) {
@@ -349,7 +495,7 @@ std::vector<std::shared_ptr<MeshModel>>& Scene::GetModels()
 	return models;
 }
 
-std::vector<Camera*> Scene::GetCameras()
+const std::vector<Camera*>& Scene::GetCameras() const
 {
 	return cameras;
 }
\ No newline at end of file
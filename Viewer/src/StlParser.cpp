@@ -0,0 +1,118 @@
+#include "StlParser.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#define STL_HEADER_SIZE						80
+#define STL_TRIANGLE_SIZE					50
+#define STL_PROGRESS_STEP					65536
+
+// Positions are merged by their exact bit patterns
+typedef struct _STL_POSITION_KEY_
+{
+	uint32_t bits[3];
+
+	bool operator==(const _STL_POSITION_KEY_& other) const
+	{
+		return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+	}
+
+} STL_POSITION_KEY, *PSTL_POSITION_KEY;
+
+struct StlPositionHash
+{
+	size_t operator()(const STL_POSITION_KEY& key) const
+	{
+		uint64_t hash = ((uint64_t) key.bits[0] * 0x9E3779B97F4A7C15ull) ^ ((uint64_t) key.bits[1] * 0xC2B2AE3D27D4EB4Full) ^ ((uint64_t) key.bits[2] * 0x165667B19E3779F9ull);
+		return (size_t) (hash ^ (hash >> 32));
+	}
+};
+
+RETURN_VALUE StlParser::ParseFile(const std::string& filePath, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	MappedFile file;
+
+	if (file.Open(filePath) != SUCCESS) {
+		return IO_ERROR;
+	}
+
+	return Parse(file.GetData(), file.GetEnd(), meshData, progress);
+}
+
+RETURN_VALUE StlParser::Parse(const char* begin, const char* end, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	size_t size = end - begin;
+	uint32_t triangleCount;
+
+	if (size < STL_HEADER_SIZE + sizeof(triangleCount)) {
+		return FAILURE;
+	}
+
+	memcpy(&triangleCount, begin + STL_HEADER_SIZE, sizeof(triangleCount));
+
+	// The size has to match the triangle count exactly, which also rejects ASCII files starting with "solid"
+	if (size != STL_HEADER_SIZE + sizeof(triangleCount) + (uint64_t) triangleCount * STL_TRIANGLE_SIZE) {
+		fprintf(stderr, "Only binary .stl files are supported\n");
+		return FAILURE;
+	}
+
+	std::unordered_map<STL_POSITION_KEY, int, StlPositionHash> positions;
+	positions.reserve(triangleCount / 2 + 1);
+	meshData.vertices.reserve(triangleCount / 2 + 1);
+	meshData.vertexIndices.resize((size_t) triangleCount * FACE_ELEMENTS);
+	meshData.normalIndices.resize((size_t) triangleCount * FACE_ELEMENTS);
+
+	const char* cursor = begin + STL_HEADER_SIZE + sizeof(triangleCount);
+
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++, cursor += STL_TRIANGLE_SIZE)
+	{
+		if (progress && triangle % STL_PROGRESS_STEP == 0)
+		{
+			progress->fraction = (float) triangle / triangleCount;
+
+			if (progress->cancelled) {
+				return FAILURE;
+			}
+		}
+
+		// A record is the face normal followed by the three corners, all little endian floats
+		float record[4][3];
+		memcpy(record, cursor, sizeof(record));
+
+		glm::vec3 normal(record[0][0], record[0][1], record[0][2]);
+		int normalIndex = -1;
+
+		if (normal.x != 0 || normal.y != 0 || normal.z != 0) {
+			meshData.normals.push_back(normal);
+			normalIndex = (int) meshData.normals.size() - 1;
+		}
+
+		for (int corner = 0; corner < FACE_ELEMENTS; corner++)
+		{
+			STL_POSITION_KEY key;
+
+			// Adding zero turns -0 into 0, so both land on the same vertex
+			for (int axis = 0; axis < 3; axis++) {
+				float coordinate = record[corner + 1][axis] + 0.0f;
+				memcpy(&key.bits[axis], &coordinate, sizeof(float));
+			}
+
+			auto inserted = positions.insert(std::make_pair(key, (int) meshData.vertices.size()));
+
+			if (inserted.second) {
+				meshData.vertices.push_back(glm::vec3(record[corner + 1][0], record[corner + 1][1], record[corner + 1][2]));
+			}
+
+			meshData.vertexIndices[(size_t) triangle * FACE_ELEMENTS + corner] = inserted.first->second;
+			meshData.normalIndices[(size_t) triangle * FACE_ELEMENTS + corner] = normalIndex;
+		}
+	}
+
+	if (meshData.normals.empty()) {
+		meshData.normalIndices.clear();
+	}
+
+	return SUCCESS;
+}
@@ -0,0 +1,369 @@
+#include "TransformKernels.h"
+#include "MeshGeometry.h"
+#include "ObjParser.h"
+#include "Constants.h"
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <intrin.h>
+#include <immintrin.h>
+#include <Windows.h>
+
+#define BENCHMARK_REPETITIONS				5
+// Small models are transformed repeatedly, so every timed run covers about this many vertices
+#define BENCHMARK_MIN_VERTICES				4000000
+// Blends taking lanes 1, 4, 7 and lanes 2, 5 from the second operand (see TransformAvx2)
+#define AVX2_BLEND_147						0x92
+#define AVX2_BLEND_25						0x24
+
+// The operations of every kernel, in the same order, so that all of them round alike
+static inline void TransformVertex(const float* m, float x, float y, float z, float* transformed)
+{
+	float w = m[3] * x + m[7] * y + m[11] * z + m[15];
+
+	transformed[0] = (m[0] * x + m[4] * y + m[8] * z + m[12]) / w;
+	transformed[1] = (m[1] * x + m[5] * y + m[9] * z + m[13]) / w;
+	transformed[2] = (m[2] * x + m[6] * y + m[10] * z + m[14]) / w;
+}
+
+static inline __m128 TransformRow(const __m128* m, int row, __m128 x, __m128 y, __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row], x), _mm_mul_ps(m[4 + row], y)), _mm_mul_ps(m[8 + row], z)), m[12 + row]);
+}
+
+static inline __m256 TransformRow(const __m256* m, int row, __m256 x, __m256 y, __m256 z)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row], x), _mm256_mul_ps(m[4 + row], y)), _mm256_mul_ps(m[8 + row], z)), m[12 + row]);
+}
+
+// 4 packed vertices (x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3) to and from one register per coordinate.
+// The shuffles put every coordinate in the lane it has in the packed registers, the blends then pick the lanes.
+static inline void LoadPacked(const float* vertices, __m128& x, __m128& y, __m128& z)
+{
+	__m128 packed0 = _mm_loadu_ps(vertices);
+	__m128 packed1 = _mm_loadu_ps(vertices + 4);
+	__m128 packed2 = _mm_loadu_ps(vertices + 8);
+
+	x = _mm_blend_ps(_mm_blend_ps(packed0, packed2, 0x2), packed1, 0x4);
+	y = _mm_blend_ps(_mm_blend_ps(packed1, packed0, 0x2), packed2, 0x4);
+	z = _mm_blend_ps(_mm_blend_ps(packed2, packed1, 0x2), packed0, 0x4);
+
+	x = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+static inline void StorePacked(float* transformed, __m128 x, __m128 y, __m128 z)
+{
+	x = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 0, 1, 2));
+
+	_mm_storeu_ps(transformed, _mm_blend_ps(_mm_blend_ps(x, y, 0x2), z, 0x4));
+	_mm_storeu_ps(transformed + 4, _mm_blend_ps(_mm_blend_ps(y, z, 0x2), x, 0x4));
+	_mm_storeu_ps(transformed + 8, _mm_blend_ps(_mm_blend_ps(z, x, 0x2), y, 0x4));
+}
+
+// The same for 8 vertices in three 256 bit registers, with lane crossing permutes instead of the shuffles
+static inline void LoadPacked(const float* vertices, __m256& x, __m256& y, __m256& z)
+{
+	__m256 packed0 = _mm256_loadu_ps(vertices);
+	__m256 packed1 = _mm256_loadu_ps(vertices + 8);
+	__m256 packed2 = _mm256_loadu_ps(vertices + 16);
+
+	x = _mm256_blend_ps(_mm256_blend_ps(packed0, packed1, AVX2_BLEND_147), packed2, AVX2_BLEND_25);
+	y = _mm256_blend_ps(_mm256_blend_ps(packed2, packed0, AVX2_BLEND_147), packed1, AVX2_BLEND_25);
+	z = _mm256_blend_ps(_mm256_blend_ps(packed1, packed2, AVX2_BLEND_147), packed0, AVX2_BLEND_25);
+
+	x = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+	y = _mm256_permutevar8x32_ps(y, _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+	z = _mm256_permutevar8x32_ps(z, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+}
+
+static inline void StorePacked(float* transformed, __m256 x, __m256 y, __m256 z)
+{
+	x = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+	y = _mm256_permutevar8x32_ps(y, _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2));
+	z = _mm256_permutevar8x32_ps(z, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+
+	_mm256_storeu_ps(transformed, _mm256_blend_ps(_mm256_blend_ps(x, y, AVX2_BLEND_147), z, AVX2_BLEND_25));
+	_mm256_storeu_ps(transformed + 8, _mm256_blend_ps(_mm256_blend_ps(z, x, AVX2_BLEND_147), y, AVX2_BLEND_25));
+	_mm256_storeu_ps(transformed + 16, _mm256_blend_ps(_mm256_blend_ps(y, z, AVX2_BLEND_147), x, AVX2_BLEND_25));
+}
+
+TRANSFORM_KERNEL TransformKernels::DetectKernel()
+{
+	int info[4];
+
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool hasSse41 = (info[2] & (1 << 19)) != 0;
+	// AVX registers are only usable if the operating system saves them (OSXSAVE, and XCR0 has SSE and AVX state)
+	bool hasAvx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+	bool hasAvx2 = false;
+
+	if (hasAvx && maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		hasAvx2 = (info[1] & (1 << 5)) != 0;
+	}
+
+	return hasAvx2 ? TRANSFORM_KERNEL_AVX2 : (hasSse41 ? TRANSFORM_KERNEL_SSE41 : TRANSFORM_KERNEL_SCALAR);
+}
+
+TRANSFORM_KERNEL TransformKernels::GetBestKernel()
+{
+	static const TRANSFORM_KERNEL bestKernel = DetectKernel();
+	return bestKernel;
+}
+
+TRANSFORM_KERNEL TransformKernels::Resolve(TRANSFORM_KERNEL kernel)
+{
+	return kernel == TRANSFORM_KERNEL_AUTO || kernel > GetBestKernel() ? GetBestKernel() : kernel;
+}
+
+const char* TransformKernels::GetKernelName(TRANSFORM_KERNEL kernel)
+{
+	switch (Resolve(kernel))
+	{
+		case TRANSFORM_KERNEL_SSE41:
+			return "SSE4.1";
+		case TRANSFORM_KERNEL_AVX2:
+			return "AVX2";
+		default:
+			return "Scalar";
+	}
+}
+
+void TransformKernels::Transform(const glm::vec3* vertices, size_t count, const glm::mat4x4& transformation, glm::vec3* transformed, TRANSFORM_KERNEL kernel)
+{
+	// glm::vec3 is three packed floats, so the arrays are read and written as plain float arrays
+	const float* input = reinterpret_cast<const float*>(vertices);
+	float* output = reinterpret_cast<float*>(transformed);
+
+	switch (Resolve(kernel))
+	{
+		case TRANSFORM_KERNEL_SSE41:
+			TransformSse41(input, count, transformation, output);
+			break;
+		case TRANSFORM_KERNEL_AVX2:
+			TransformAvx2(input, count, transformation, output);
+			break;
+		default:
+			for (size_t i = 0; i < count; i++) {
+				TransformVertex(&transformation[0][0], input[i * 3], input[i * 3 + 1], input[i * 3 + 2], output + i * 3);
+			}
+			break;
+	}
+}
+
+void TransformKernels::Transform(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, glm::vec3* transformed, TRANSFORM_KERNEL kernel)
+{
+	switch (Resolve(kernel))
+	{
+		case TRANSFORM_KERNEL_SSE41:
+			TransformSse41(streams, transformation, reinterpret_cast<float*>(transformed));
+			break;
+		case TRANSFORM_KERNEL_AVX2:
+			TransformAvx2(streams, transformation, reinterpret_cast<float*>(transformed));
+			break;
+		default:
+			VertexStreams::Transform(streams, transformation, transformed);
+			break;
+	}
+}
+
+void TransformKernels::TransformSse41(const float* vertices, size_t count, const glm::mat4x4& transformation, float* transformed)
+{
+	const float* elements = &transformation[0][0];
+	__m128 m[16];
+	size_t i = 0;
+
+	for (int element = 0; element < 16; element++) {
+		m[element] = _mm_set1_ps(elements[element]);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x, y, z;
+		LoadPacked(vertices + i * 3, x, y, z);
+
+		__m128 w = TransformRow(m, 3, x, y, z);
+		StorePacked(transformed + i * 3, _mm_div_ps(TransformRow(m, 0, x, y, z), w), _mm_div_ps(TransformRow(m, 1, x, y, z), w), _mm_div_ps(TransformRow(m, 2, x, y, z), w));
+	}
+
+	for (; i < count; i++) {
+		TransformVertex(elements, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], transformed + i * 3);
+	}
+}
+
+void TransformKernels::TransformSse41(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, float* transformed)
+{
+	const float* elements = &transformation[0][0];
+	__m128 m[16];
+	size_t i = 0;
+
+	for (int element = 0; element < 16; element++) {
+		m[element] = _mm_set1_ps(elements[element]);
+	}
+
+	// The streams are aligned to SIMD_ALIGNMENT, which covers the aligned loads of both kernels
+	for (; i + 4 <= streams.count; i += 4)
+	{
+		__m128 x = _mm_load_ps(streams.x.data() + i);
+		__m128 y = _mm_load_ps(streams.y.data() + i);
+		__m128 z = _mm_load_ps(streams.z.data() + i);
+
+		__m128 w = TransformRow(m, 3, x, y, z);
+		StorePacked(transformed + i * 3, _mm_div_ps(TransformRow(m, 0, x, y, z), w), _mm_div_ps(TransformRow(m, 1, x, y, z), w), _mm_div_ps(TransformRow(m, 2, x, y, z), w));
+	}
+
+	for (; i < streams.count; i++) {
+		TransformVertex(elements, streams.x[i], streams.y[i], streams.z[i], transformed + i * 3);
+	}
+}
+
+void TransformKernels::TransformAvx2(const float* vertices, size_t count, const glm::mat4x4& transformation, float* transformed)
+{
+	const float* elements = &transformation[0][0];
+	__m256 m[16];
+	size_t i = 0;
+
+	for (int element = 0; element < 16; element++) {
+		m[element] = _mm256_set1_ps(elements[element]);
+	}
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x, y, z;
+		LoadPacked(vertices + i * 3, x, y, z);
+
+		__m256 w = TransformRow(m, 3, x, y, z);
+		StorePacked(transformed + i * 3, _mm256_div_ps(TransformRow(m, 0, x, y, z), w), _mm256_div_ps(TransformRow(m, 1, x, y, z), w), _mm256_div_ps(TransformRow(m, 2, x, y, z), w));
+	}
+
+	for (; i < count; i++) {
+		TransformVertex(elements, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], transformed + i * 3);
+	}
+}
+
+void TransformKernels::TransformAvx2(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, float* transformed)
+{
+	const float* elements = &transformation[0][0];
+	__m256 m[16];
+	size_t i = 0;
+
+	for (int element = 0; element < 16; element++) {
+		m[element] = _mm256_set1_ps(elements[element]);
+	}
+
+	for (; i + 8 <= streams.count; i += 8)
+	{
+		__m256 x = _mm256_load_ps(streams.x.data() + i);
+		__m256 y = _mm256_load_ps(streams.y.data() + i);
+		__m256 z = _mm256_load_ps(streams.z.data() + i);
+
+		__m256 w = TransformRow(m, 3, x, y, z);
+		StorePacked(transformed + i * 3, _mm256_div_ps(TransformRow(m, 0, x, y, z), w), _mm256_div_ps(TransformRow(m, 1, x, y, z), w), _mm256_div_ps(TransformRow(m, 2, x, y, z), w));
+	}
+
+	for (; i < streams.count; i++) {
+		TransformVertex(elements, streams.x[i], streams.y[i], streams.z[i], transformed + i * 3);
+	}
+}
+
+void TransformKernels::Benchmark(const std::string& directory)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((directory + "\\*.obj").c_str(), &findData);
+
+	if (findHandle == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "No .obj files were found in %s\n", directory.c_str());
+		return;
+	}
+
+	const TRANSFORM_KERNEL kernels[] = { TRANSFORM_KERNEL_SCALAR, TRANSFORM_KERNEL_SSE41, TRANSFORM_KERNEL_AVX2 };
+	const int kernelCount = sizeof(kernels) / sizeof(kernels[0]);
+
+	// A perspective view of the normalized model, mapped to the pixels of a 1280 x 720 viewport
+	glm::mat4x4 transformation = glm::mat4x4(TRANSLATION_MATRIX(640.0f, 360.0f, 0.0f)) * glm::mat4x4(HOMOGENEOUS_MATRIX4(SCREEN_SCALE, SCREEN_SCALE, 1.0f, 1.0f)) *
+		glm::mat4x4(PERSPECTIVE_MATRIX(-2.0f)) * glm::mat4x4(TRANSLATION_MATRIX(0.0f, 0.0f, -3.0f));
+
+	printf("Best kernel on this CPU: %s, million vertices per second\n", GetKernelName(GetBestKernel()));
+	printf("%-20s %10s %10s %10s %10s %12s %12s %12s %10s\n", "Model", "Vertices", "Scalar", "SSE4.1", "AVX2", "SoA Scalar", "SoA SSE4.1", "SoA AVX2", "Identical");
+
+	do
+	{
+		MESH_DATA meshData;
+
+		if (ObjParser::ParseFile(directory + "\\" + findData.cFileName, meshData) != SUCCESS) {
+			continue;
+		}
+
+		MeshGeometry geometry(std::move(meshData));
+		const std::vector<glm::vec3>& vertices = geometry.GetVertexBuffer();
+		const VERTEX_STREAMS& streams = geometry.GetPositionStreams();
+
+		if (vertices.empty()) {
+			continue;
+		}
+
+		size_t runs = vertices.size() < BENCHMARK_MIN_VERTICES ? BENCHMARK_MIN_VERTICES / vertices.size() : 1;
+		std::vector<glm::vec3> reference(vertices.size());
+		std::vector<glm::vec3> transformed(vertices.size());
+		double verticesPerSecond[2][kernelCount] = { 0 };
+		bool isIdentical = true;
+
+		Transform(vertices.data(), vertices.size(), transformation, reference.data(), TRANSFORM_KERNEL_SCALAR);
+
+		for (int layout = 0; layout < 2; layout++)
+		{
+			for (int kernel = 0; kernel < kernelCount && kernels[kernel] <= GetBestKernel(); kernel++)
+			{
+				double seconds = DBL_MAX;
+
+				// Keep the best of a few runs
+				for (int i = 0; i < BENCHMARK_REPETITIONS; i++)
+				{
+					auto start = std::chrono::high_resolution_clock::now();
+
+					for (size_t run = 0; run < runs; run++) {
+						if (layout == 0) {
+							Transform(vertices.data(), vertices.size(), transformation, transformed.data(), kernels[kernel]);
+						}
+						else {
+							Transform(streams, transformation, transformed.data(), kernels[kernel]);
+						}
+					}
+
+					seconds = fmin(seconds, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+				}
+
+				verticesPerSecond[layout][kernel] = vertices.size() * runs / seconds / 1e6;
+				isIdentical = isIdentical && memcmp(transformed.data(), reference.data(), reference.size() * sizeof(glm::vec3)) == 0;
+			}
+		}
+
+		printf("%-20s %10u", findData.cFileName, (unsigned int) vertices.size());
+
+		for (int layout = 0; layout < 2; layout++) {
+			for (int kernel = 0; kernel < kernelCount; kernel++) {
+				if (kernels[kernel] <= GetBestKernel()) {
+					printf(layout == 0 ? " %10.1f" : " %12.1f", verticesPerSecond[layout][kernel]);
+				}
+				else {
+					printf(layout == 0 ? " %10s" : " %12s", "-");
+				}
+			}
+		}
+
+		printf(" %10s\n", isIdentical ? "yes" : "no");
+
+	} while (FindNextFileA(findHandle, &findData));
+
+	FindClose(findHandle);
+}
@@ -1,12 +1,24 @@
 #include "Utils.h"
 #include "Constants.h"
+#include "ObjParser.h"
+#include "PlyParser.h"
+#include "StlParser.h"
+#include "GlbParser.h"
+#include "MeshCache.h"
+#include "GeometryStore.h"
+#include "PagedMesh.h"
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include <Windows.h>
 
+#define PREVIEW_MAX_FACES					65536
+
 glm::vec3 Utils::Vec3fFromStream(std::istream& issLine)
 {
 	float x, y, z;
@@ -23,72 +35,175 @@ glm::vec2 Utils::Vec2fFromStream(std::istream& issLine)
 
 MeshModel Utils::LoadMeshModel(const std::string& filePath)
 {
-	std::vector<Face> faces;
-	std::vector<glm::vec3> vertices;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec3> textureVertices;
-	std::string fullPath;
+	std::shared_ptr<MeshModel> model = LoadMeshModel(filePath, nullptr);
 
-	if (filePath.find("obj_examples") != std::string::npos)
-	{
-		fullPath = filePath;
-	}
-	else 
-	{
-		fullPath = GetWorkingDirectory() + filePath;
+	if (!model) {
+		exit(-1);
 	}
 
-	std::ifstream ifile(fullPath.c_str());
+	return *model;
+}
 
-	if (ifile.fail()) {
-		fprintf(stderr, "An error occured while trying to open %s", Utils::GetFileName(filePath));
-		exit(-1);
-	}
+std::shared_ptr<MeshModel> Utils::LoadMeshModel(const std::string& filePath, PLOAD_PROGRESS progress)
+{
+	std::string fullPath = GetFullPath(filePath);
 
-	// while not end of file
-	while (!ifile.eof())
-	{
-		// get line
-		std::string curLine;
-		getline(ifile, curLine);
+	// Contents which are already loaded are shared, whatever path they were opened from. The file is only hashed
+	// when geometry of the same size is in use, so a new model is not read once more just to identify it.
+	GEOMETRY_KEY key;
+	bool hasKey = GeometryStore::GetSourceKey(fullPath, key) == SUCCESS;
+	std::shared_ptr<const MeshGeometry> geometry = hasKey ? GeometryStore::Find(key) : nullptr;
 
-		// read the type of the line
-		std::istringstream issLine(curLine);
-		std::string lineType;
+	if (!geometry) {
+		geometry = LoadMeshGeometry(filePath, fullPath, progress);
 
-		issLine >> std::ws >> lineType;
+		if (!geometry) {
+			return nullptr;
+		}
 
-		// based on the type parse data
-		if (lineType == "v")
-		{
-			glm::vec3 parsedVector = Vec3fFromStream(issLine);
-			vertices.push_back(parsedVector);
+		if (hasKey) {
+			geometry = GeometryStore::Insert(key, geometry);
 		}
-		else if (lineType == "vn")
-		{
-			normals.push_back(Vec3fFromStream(issLine));
+	}
+
+	return std::make_shared<MeshModel>(geometry, Utils::GetFileName(filePath));
+}
+
+std::shared_ptr<MeshModel> Utils::LoadPagedMeshModel(const std::string& filePath, PLOAD_PROGRESS progress)
+{
+	std::string fullPath = GetFullPath(filePath);
+	const uint64_t byteBudget = (uint64_t) PAGED_MESH_DEFAULT_BUDGET_MB << 20;
+
+	// The page file is written on the first load only
+	std::shared_ptr<PagedMesh> pagedMesh = PagedMesh::Open(fullPath, byteBudget);
+
+	if (!pagedMesh) {
+		// An .obj is streamed straight from the file, so it never has to fit in memory. The other formats are
+		// parsed once and their arrays handed to the build.
+		std::string extension = GetFileExtension(filePath);
+		MESH_DATA meshData;
+		MESH_SCAN scan;
+
+		if (extension == "ply" || extension == "stl" || extension == "glb") {
+			if (ParseMeshFile(filePath, fullPath, meshData, progress) != SUCCESS) {
+				return nullptr;
+			}
+
+			scan = [&meshData](const std::function<void(const glm::vec3&)>& onVertex, const std::function<void(const int*)>& onFace, float, float) {
+				for each (const glm::vec3& vertex in meshData.vertices) {
+					onVertex(vertex);
+				}
+
+				for (size_t i = 0; i + FACE_ELEMENTS <= meshData.vertexIndices.size(); i += FACE_ELEMENTS) {
+					onFace(&meshData.vertexIndices[i]);
+				}
+
+				return SUCCESS;
+			};
 		}
-		else if (lineType == "vt")
-		{
-			// Texture coordinates
-			// I did not see that any of the files we have contains "vt" line, so did not implement the logic..
-			// ...
+		else {
+			scan = [&fullPath, progress](const std::function<void(const glm::vec3&)>& onVertex, const std::function<void(const int*)>& onFace, float progressBegin, float progressEnd) {
+				return ObjParser::Scan(fullPath, onVertex, onFace, progress, progressBegin, progressEnd);
+			};
 		}
-		else if (lineType == "f")
-		{
-			faces.push_back(Face(issLine));
+
+		RETURN_VALUE result = PagedMesh::Build(fullPath, scan, progress);
+
+		if (result == IO_ERROR) {
+			fprintf(stderr, "Could not write the pages of %s\n", Utils::GetFileName(filePath).c_str());
 		}
-		else if (lineType == "#" || lineType == "")
-		{
-			// comment / empty line
+
+		if (result != SUCCESS) {
+			return nullptr;
 		}
-		else
-		{
-			std::cout << "Found unknown line Type \"" << lineType << "\"";
+
+		pagedMesh = PagedMesh::Open(fullPath, byteBudget);
+
+		if (!pagedMesh) {
+			return nullptr;
 		}
 	}
 
-	return MeshModel(faces, vertices, normals, Utils::GetFileName(filePath));
+	return std::make_shared<PagedMeshModel>(pagedMesh, Utils::GetFileName(filePath));
+}
+
+std::shared_ptr<const MeshGeometry> Utils::LoadMeshGeometry(const std::string& filePath, const std::string& fullPath, PLOAD_PROGRESS progress)
+{
+	MESH_DATA meshData;
+
+	// Reopening a model we have seen before skips parsing and normalization altogether
+	std::shared_ptr<MeshGeometry> geometry = MeshCache::Load(fullPath);
+
+	if (geometry) {
+		return geometry;
+	}
+
+	if (ParseMeshFile(filePath, fullPath, meshData, progress) != SUCCESS) {
+		return nullptr;
+	}
+
+	geometry = std::make_shared<MeshGeometry>(std::move(meshData));
+	MeshCache::Store(fullPath, *geometry);
+
+	return geometry;
+}
+
+RETURN_VALUE Utils::ParseMeshFile(const std::string& filePath, const std::string& fullPath, MESH_DATA& meshData, PLOAD_PROGRESS progress)
+{
+	// Pick the reader by the file extension, anything unknown is read as .obj
+	std::string extension = GetFileExtension(filePath);
+	RETURN_VALUE result;
+
+	if (extension == "ply") {
+		result = PlyParser::ParseFile(fullPath, meshData, progress);
+	}
+	else if (extension == "stl") {
+		result = StlParser::ParseFile(fullPath, meshData, progress);
+	}
+	else if (extension == "glb") {
+		result = GlbParser::ParseFile(fullPath, meshData, progress);
+	}
+	else {
+		result = ObjParser::ParseFile(fullPath, meshData, progress);
+	}
+
+	if (result == IO_ERROR) {
+		fprintf(stderr, "An error occured while trying to open %s\n", Utils::GetFileName(filePath).c_str());
+	}
+
+	// Welding and normalizing a large model takes a while, show an evenly thinned out version of it meanwhile
+	if (result == SUCCESS && progress && meshData.vertexIndices.size() / FACE_ELEMENTS > PREVIEW_MAX_FACES) {
+		std::shared_ptr<const MeshGeometry> preview = BuildPreview(meshData, PREVIEW_MAX_FACES);
+		std::lock_guard<std::mutex> lock(progress->previewMutex);
+		progress->preview = preview;
+	}
+
+	return result;
+}
+
+std::shared_ptr<const MeshGeometry> Utils::BuildPreview(const MESH_DATA& meshData, size_t maxFaces)
+{
+	MESH_DATA preview;
+	std::unordered_map<int, int> previewVertices;
+	size_t faceCount = meshData.vertexIndices.size() / FACE_ELEMENTS;
+	size_t stride = (faceCount + maxFaces - 1) / maxFaces;
+
+	preview.vertexIndices.reserve((faceCount / stride + 1) * FACE_ELEMENTS);
+
+	for (size_t face = 0; face < faceCount; face += stride) {
+		for (int corner = 0; corner < FACE_ELEMENTS; corner++) {
+			int vertexIndex = meshData.vertexIndices[face * FACE_ELEMENTS + corner];
+			auto inserted = previewVertices.insert(std::make_pair(vertexIndex, (int) preview.vertices.size()));
+
+			if (inserted.second) {
+				preview.vertices.push_back(meshData.vertices[vertexIndex]);
+			}
+
+			preview.vertexIndices.push_back(inserted.first->second);
+		}
+	}
+
+	return std::make_shared<MeshGeometry>(std::move(preview));
 }
 
 std::string Utils::GetWorkingDirectory()
@@ -98,6 +213,18 @@ std::string Utils::GetWorkingDirectory()
 	return std::string(buf) + '\\';
 }
 
+std::string Utils::GetFullPath(const std::string& filePath)
+{
+	if (filePath.find("obj_examples") != std::string::npos)
+	{
+		return filePath;
+	}
+	else
+	{
+		return GetWorkingDirectory() + filePath;
+	}
+}
+
 std::string Utils::GetFileName(const std::string& filePath)
 {
 	if (filePath.empty()) {
@@ -134,6 +261,21 @@ std::string Utils::GetFileName(const std::string& filePath)
 	return filePath.substr(index + 1, len - index);
 }
 
+std::string Utils::GetFileExtension(const std::string& filePath)
+{
+	std::string fileName = GetFileName(filePath);
+	auto index = fileName.find_last_of('.');
+
+	if (index == std::string::npos) {
+		return {};
+	}
+
+	std::string extension = fileName.substr(index + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char) tolower((unsigned char) c); });
+
+	return extension;
+}
+
 glm::vec4 Utils::ToHomogeneousForm(const glm::vec3& normalForm)
 {
 	return glm::vec4(normalForm.x, normalForm.y, normalForm.z, 1);
@@ -0,0 +1,54 @@
+#include "VertexStreams.h"
+
+size_t VertexStreams::GetPaddedCount(size_t count)
+{
+	return (count + SIMD_FLOAT_WIDTH - 1) / SIMD_FLOAT_WIDTH * SIMD_FLOAT_WIDTH;
+}
+
+size_t VertexStreams::GetBytes(const VERTEX_STREAMS& streams)
+{
+	return (streams.x.capacity() + streams.y.capacity() + streams.z.capacity()) * sizeof(float);
+}
+
+void VertexStreams::Build(Span<const glm::vec3> vertices, VERTEX_STREAMS& streams)
+{
+	size_t paddedCount = GetPaddedCount(vertices.size());
+
+	streams.count = vertices.size();
+	streams.x.resize(paddedCount);
+	streams.y.resize(paddedCount);
+	streams.z.resize(paddedCount);
+
+	for (size_t i = 0; i < vertices.size(); i++) {
+		streams.x[i] = vertices[i].x;
+		streams.y[i] = vertices[i].y;
+		streams.z[i] = vertices[i].z;
+	}
+
+	// Repeating the last vertex keeps the padding out of any minimum or maximum
+	for (size_t i = vertices.size(); i < paddedCount; i++) {
+		streams.x[i] = vertices[vertices.size() - 1].x;
+		streams.y[i] = vertices[vertices.size() - 1].y;
+		streams.z[i] = vertices[vertices.size() - 1].z;
+	}
+}
+
+void VertexStreams::Transform(const VERTEX_STREAMS& streams, const glm::mat4x4& transformation, glm::vec3* transformed)
+{
+	const float* x = streams.x.data();
+	const float* y = streams.y.data();
+	const float* z = streams.z.data();
+
+	const float m00 = transformation[0][0], m01 = transformation[0][1], m02 = transformation[0][2], m03 = transformation[0][3];
+	const float m10 = transformation[1][0], m11 = transformation[1][1], m12 = transformation[1][2], m13 = transformation[1][3];
+	const float m20 = transformation[2][0], m21 = transformation[2][1], m22 = transformation[2][2], m23 = transformation[2][3];
+	const float m30 = transformation[3][0], m31 = transformation[3][1], m32 = transformation[3][2], m33 = transformation[3][3];
+
+	for (size_t i = 0; i < streams.count; i++) {
+		float w = m03 * x[i] + m13 * y[i] + m23 * z[i] + m33;
+
+		transformed[i].x = (m00 * x[i] + m10 * y[i] + m20 * z[i] + m30) / w;
+		transformed[i].y = (m01 * x[i] + m11 * y[i] + m21 * z[i] + m31) / w;
+		transformed[i].z = (m02 * x[i] + m12 * y[i] + m22 * z[i] + m32) / w;
+	}
+}
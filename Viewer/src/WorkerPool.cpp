@@ -0,0 +1,100 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t threadCount) :
+	task(nullptr),
+	taskCount(0),
+	nextTask(0),
+	generation(0),
+	finishedWorkers(0),
+	stopping(false)
+{
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+	}
+
+	for (size_t i = 1; i < threadCount; i++) {
+		workers.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+
+	jobCondition.notify_all();
+
+	for each (std::thread& worker in workers) {
+		worker.join();
+	}
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)>& job)
+{
+	if (workers.empty() || count <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			job(i);
+		}
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		task = &job;
+		taskCount = count;
+		nextTask = 0;
+		finishedWorkers = 0;
+		generation++;
+	}
+
+	jobCondition.notify_all();
+	RunTasks(job, count);
+
+	// Every worker has to have seen the job before it goes out of scope, even one which woke up too late to help
+	std::unique_lock<std::mutex> lock(jobMutex);
+	doneCondition.wait(lock, [this]() { return finishedWorkers == workers.size(); });
+	task = nullptr;
+}
+
+void WorkerPool::WorkerLoop()
+{
+	size_t seenGeneration = 0;
+
+	while (true)
+	{
+		const std::function<void(size_t)>* job;
+		size_t count;
+
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobCondition.wait(lock, [this, seenGeneration]() { return stopping || generation != seenGeneration; });
+
+			if (stopping) {
+				return;
+			}
+
+			seenGeneration = generation;
+			job = task;
+			count = taskCount;
+		}
+
+		RunTasks(*job, count);
+
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			finishedWorkers++;
+		}
+
+		doneCondition.notify_one();
+	}
+}
+
+void WorkerPool::RunTasks(const std::function<void(size_t)>& job, size_t count)
+{
+	for (size_t i = nextTask++; i < count; i = nextTask++) {
+		job(i);
+	}
+}
@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
+#include <cstring>
 
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -13,6 +14,8 @@
 #include "Scene.h"
 #include "Camera.h"
 #include "ImguiMenus.h"
+#include "ObjParser.h"
+#include "TransformKernels.h"
 
 // Custom pre-defined constants to be used all around the application
 #include "Constants.h"
@@ -35,6 +38,43 @@ void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 
 int main(int argc, char **argv)
 {
+	// Loader benchmark mode: MeshViewer --benchmark [directory of .obj files]
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		ObjParser::Benchmark(argc > 2 ? argv[2] : OBJ_EXAMPLES_DIRECTORY);
+		return 0;
+	}
+
+	// Vertex transform benchmark mode: MeshViewer --benchmark-transform [directory of .obj files]
+	if (argc > 1 && strcmp(argv[1], "--benchmark-transform") == 0)
+	{
+		TransformKernels::Benchmark(argc > 2 ? argv[2] : OBJ_EXAMPLES_DIRECTORY);
+		return 0;
+	}
+
+	// Rasterizer benchmark mode: MeshViewer --benchmark-raster [directory of .obj files]
+	if (argc > 1 && strcmp(argv[1], "--benchmark-raster") == 0)
+	{
+		// The renderer creates its screen texture, so it needs a window even though nothing is shown
+		GLFWwindow* window = SetupGlfwWindow(DEFAULT_WIDTH, DEFAULT_HEIGHT, WINDOW_TITLE);
+		if (!window)
+		{
+			return 1;
+		}
+
+		int frameBufferWidth, frameBufferHeight;
+		glfwGetFramebufferSize(window, &frameBufferWidth, &frameBufferHeight);
+
+		{
+			Renderer renderer(frameBufferWidth, frameBufferHeight);
+			renderer.Benchmark(argc > 2 ? argv[2] : OBJ_EXAMPLES_DIRECTORY);
+		}
+
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return 0;
+	}
+
 	// Create GLFW window
 	GLFWwindow* window = SetupGlfwWindow(DEFAULT_WIDTH, DEFAULT_HEIGHT, WINDOW_TITLE);
 	if (!window)